@@ -5,33 +5,35 @@
 #include <algorithm>
 #include <cstdint>
 #include <vector>
-
-inline bool edit_distance_k(
-    std::string a, 
-    std::string b, 
+#include <stdexcept>
+#include "gapped_view.hpp"
+#include "../thirdparty/small_vector.hpp"
+
+// Works on any string-like type with size() and operator[]; the strings are
+// only read, so views into the input never have to be copied.
+template <typename Str>
+inline bool edit_distance_k_impl(
+    const Str& str1, 
+    const Str& str2, 
     int k
 ) {
-    if (a == b)
-        return true;
+    const Str& a = str1.size() > str2.size() ? str2 : str1;
+    const Str& b = str1.size() > str2.size() ? str1 : str2;
+    int a_end = a.size(), b_end = b.size();
 
-    if (a.size() > b.size())
-        std::swap(a, b);
-    
-    if (static_cast<int>(b.size() - a.size()) > k)
+    if (b_end - a_end > k)
         return false;
 
-    while (!a.empty() && a.back() == b.back()) {
-        a.pop_back();
-        b.pop_back();
+    while (a_end > 0 && a[a_end - 1] == b[b_end - 1]) {
+        a_end--;
+        b_end--;
     }
 
-    int a_size = a.size(), start;
-    for (start = 0; start < a_size && a[start] == b[start]; ++start);
-    a = a.substr(start);
-    b = b.substr(start);
+    int prefix_len;
+    for (prefix_len = 0; prefix_len < a_end && a[prefix_len] == b[prefix_len]; ++prefix_len);
 
-    int b_size = b.size();
-    a_size = a.size();
+    int a_size = a_end - prefix_len;
+    int b_size = b_end - prefix_len;
 
     if (a_size == 0)
         return true; // b_size <= k because otherwise b_size - a_size = b_size - 0 = b_size > k and we would have returned false earlier
@@ -44,8 +46,9 @@ inline bool edit_distance_k(
     int ZERO_K = std::min(k, a_size) / 2 + 2;
     auto array_size = size_d + ZERO_K * 2 + 2;
 
-    std::vector<int> current_row(array_size, -1);
-    std::vector<int> next_row(array_size, -1);
+    gch::small_vector<int, 64> rows(array_size * 2, -1);
+    int* current_row = rows.data();
+    int* next_row = rows.data() + array_size;
 
     int i = 0, kpp = k + 1;
     int condition_row = size_d + ZERO_K;
@@ -87,7 +90,7 @@ inline bool edit_distance_k(
                 next_cell + 1
             );
 
-            while (t < a_size && t + q < b_size && a[t] == b[t + q]) {
+            while (t < a_size && t + q < b_size && a[prefix_len + t] == b[prefix_len + t + q]) {
                 t++;
             }
 
@@ -98,14 +101,22 @@ inline bool edit_distance_k(
     return (i - 1) <= k;
 };
 
-inline bool hamming_distance_k(
-    std::string a, 
-    std::string b, 
+inline bool edit_distance_k(
+    GappedView a, 
+    GappedView b, 
+    int k
+) {
+    if (a.contiguous() && b.contiguous())
+        return edit_distance_k_impl(a.prefix, b.prefix, k);
+    return edit_distance_k_impl(a, b, k);
+};
+
+template <typename Str>
+inline bool hamming_distance_k_impl(
+    const Str& a, 
+    const Str& b, 
     int k
 ) {
-    if (a == b) 
-        return true;
-        
     int a_size = a.size(), b_size = b.size();
     int dist = abs(a_size - b_size);
     if (dist > k) 
@@ -123,7 +134,17 @@ inline bool hamming_distance_k(
     return true;
 };
 
-using distance_k_ptr = bool (*)(std::string, std::string, int);
+inline bool hamming_distance_k(
+    GappedView a, 
+    GappedView b, 
+    int k
+) {
+    if (a.contiguous() && b.contiguous())
+        return hamming_distance_k_impl(a.prefix, b.prefix, k);
+    return hamming_distance_k_impl(a, b, k);
+};
+
+using distance_k_ptr = bool (*)(GappedView, GappedView, int);
 inline distance_k_ptr get_distance_k(char metric) {
   if (metric == 'L')
     return edit_distance_k;
@@ -0,0 +1,60 @@
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include <deque>
+#include <mutex>
+#include <cstddef>
+#include <utility>
+#include <condition_variable>
+
+// FIFO of at most `capacity` items between threads that sleep while they
+// wait: push() blocks while the queue is full, pop() while it is empty.
+// Items are whole chunks of work, so the lock is taken once per chunk.
+template <typename T>
+class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+  // Appends `item` once there is room. Returns false, dropping the item, if
+  // the queue is closed.
+  bool push(T&& item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_full.wait(lock, [&] { return closed || items.size() < capacity; });
+    if (closed)
+      return false;
+    items.push_back(std::move(item));
+    not_empty.notify_one();
+    return true;
+  }
+
+  // Moves the oldest item into `item` once there is one. Returns false once
+  // the queue is closed and every item pushed before is taken.
+  bool pop(T& item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_empty.wait(lock, [&] { return closed || !items.empty(); });
+    if (items.empty())
+      return false;
+    item = std::move(items.front());
+    items.pop_front();
+    not_full.notify_one();
+    return true;
+  }
+
+  // No more items are accepted; wakes every waiting thread.
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    not_full.notify_all();
+    not_empty.notify_all();
+  }
+
+private:
+  size_t capacity;
+  bool closed = false;
+  std::deque<T> items;
+  std::mutex mutex;
+  std::condition_variable not_full;
+  std::condition_variable not_empty;
+};
+
+#endif // BOUNDED_QUEUE_HPP
@@ -0,0 +1,66 @@
+#ifndef CONCURRENT_UNION_FIND_HPP
+#define CONCURRENT_UNION_FIND_HPP
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+// Lock-free disjoint sets over [0, size). Roots are linked by index (the
+// larger root under the smaller one) with a CAS, so concurrent unions never
+// form a cycle; finds halve the path as they go.
+class ConcurrentUnionFind {
+public:
+  explicit ConcurrentUnionFind(size_t size = 0) : parent(size) {
+    #pragma omp parallel for
+    for (size_t i = 0; i < size; i++)
+      parent[i].store(i, std::memory_order_relaxed);
+  }
+
+  size_t size() const { return parent.size(); }
+  bool empty() const { return parent.empty(); }
+
+  uint32_t find(uint32_t x) {
+    while (true) {
+      uint32_t p = parent[x].load(std::memory_order_acquire);
+      if (p == x)
+        return x;
+      uint32_t grandparent = parent[p].load(std::memory_order_acquire);
+      if (grandparent != p)
+        parent[x].compare_exchange_weak(p, grandparent, std::memory_order_acq_rel);
+      x = grandparent;
+    }
+  }
+
+  // A root found by find() may be linked meanwhile: the answer is only
+  // final once one of the roots is still a root after the comparison.
+  bool same(uint32_t x, uint32_t y) {
+    while (true) {
+      x = find(x);
+      y = find(y);
+      if (x == y)
+        return true;
+      if (parent[x].load(std::memory_order_acquire) == x)
+        return false;
+    }
+  }
+
+  void unite(uint32_t x, uint32_t y) {
+    while (true) {
+      x = find(x);
+      y = find(y);
+      if (x == y)
+        return;
+      if (x < y)
+        std::swap(x, y);
+      uint32_t expected = x;
+      if (parent[x].compare_exchange_strong(expected, y, std::memory_order_acq_rel))
+        return;
+    }
+  }
+
+private:
+  std::vector<std::atomic<uint32_t>> parent;
+};
+
+#endif // CONCURRENT_UNION_FIND_HPP
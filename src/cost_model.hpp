@@ -0,0 +1,80 @@
+#ifndef COST_MODEL_HPP
+#define COST_MODEL_HPP
+
+#include <vector>
+#include <string>
+#include <numeric>
+#include <algorithm>
+#include "hash_containers.hpp"
+
+// Number of tasks created per thread when work is partitioned by cost.
+constexpr size_t COST_CHUNKS_PER_THREAD = 16;
+
+// Estimated cost of generating and hashing all patterns of a string of length `len`.
+inline double pattern_cost(int cutoff, char pattern_type, size_t len) {
+  double n = len;
+  double count;
+  if (pattern_type == 'S')
+    count = cutoff == 1 ? n + 1 : n * (n + 3) / 2;
+  else if (pattern_type == 'H')
+    count = cutoff == 1 ? n + 1 : n * (n + 1) / 2 + n + 3;
+  else
+    count = cutoff == 1 ? 2 * n + 1 : 2 * n * n + 3 * n + 2;
+  return count * (n + cutoff);
+}
+
+// Estimated cost of verifying a bucket: number of pairs times average string length.
+inline double bucket_cost(
+  const std::vector<std::string_view>& strings,
+  const ints& bucket,
+  size_t trim_size
+) {
+  double total_len = 0;
+  for (int str_idx: bucket)
+    total_len += strings[str_idx].size();
+  double avg_len = std::max(total_len / bucket.size() - trim_size, 1.0);
+  double pairs = bucket.size() * (bucket.size() - 1) / 2.0;
+  return std::max(pairs, 1.0) * avg_len;
+}
+
+// Estimated cost, in nanoseconds, of deciding whether two strings within the
+// cutoff are within it: the banded Levenshtein DP fills 2 * cutoff + 1 cells
+// per character, Hamming distance scans the strings once. Fitted on timings
+// of random 12 to 24 letter amino-acid pairs.
+inline double verify_cost(char metric, int cutoff, size_t len) {
+  if (metric == 'L')
+    return 40 + 2.5 * len * (2 * cutoff + 1);
+  return 60 + 5.0 * len;
+}
+
+// Estimated cost, in nanoseconds, of a filter comparing `variant_pairs` pairs
+// of part keys of two strings; most comparisons end at the length or the
+// first character. Fitted on the same timings as verify_cost.
+inline double key_compare_cost(double variant_pairs) {
+  return 40 + 4.0 * variant_pairs;
+}
+
+// Splits items, already ordered by decreasing cost, into `n_chunks` contiguous
+// chunks of roughly equal total cost. An item costlier than the per-chunk
+// budget gets a chunk of its own. Returns chunk boundaries (n + 1 values).
+inline std::vector<size_t> cost_partition(
+  const std::vector<double>& costs,
+  size_t n_chunks
+) {
+  double total = std::accumulate(costs.begin(), costs.end(), 0.0);
+  double budget = total / std::max<size_t>(n_chunks, 1);
+  std::vector<size_t> bounds = {0};
+  double chunk_cost = 0;
+  for (size_t i = 0; i < costs.size(); i++) {
+    chunk_cost += costs[i];
+    if (chunk_cost >= budget) {
+      bounds.push_back(i + 1);
+      chunk_cost = 0;
+    }
+  }
+  if (bounds.back() != costs.size())
+    bounds.push_back(costs.size());
+  return bounds;
+}
+
+#endif // COST_MODEL_HPP
@@ -0,0 +1,40 @@
+#include "csr_graph.hpp"
+#include "edge_buffer.hpp"
+#include <omp.h>
+
+CsrGraph buildCsrGraph(const std::vector<uint64_t>& edges, size_t n_nodes) {
+  // both directions of every edge, sorted by (row, column)
+  std::vector<size_t> offsets(edges.size() + 1, 0);
+  #pragma omp parallel for
+  for (size_t k = 0; k < edges.size(); k++)
+    offsets[k + 1] = (edges[k] >> 32) == (edges[k] & 0xffffffffu) ? 1 : 2;
+  for (size_t k = 0; k < edges.size(); k++)
+    offsets[k + 1] += offsets[k];
+  std::vector<uint64_t> entries(offsets.back());
+  #pragma omp parallel for
+  for (size_t k = 0; k < edges.size(); k++) {
+    entries[offsets[k]] = edges[k];
+    if (offsets[k + 1] - offsets[k] == 2)
+      entries[offsets[k] + 1] = edges[k] << 32 | edges[k] >> 32;
+  }
+  std::vector<uint64_t> buffer;
+  radix_sort(entries, buffer);
+
+  CsrGraph graph;
+  graph.row_offsets.assign(n_nodes + 1, 0);
+  graph.col_indices.resize(entries.size());
+  size_t n_entries = entries.size();
+  // the first entry of a row sets its offset and the offsets of the empty
+  // rows before it
+  #pragma omp parallel for
+  for (size_t k = 0; k <= n_entries; k++) {
+    size_t row = k < n_entries ? entries[k] >> 32 : n_nodes;
+    size_t prev_row = k > 0 ? (entries[k - 1] >> 32) + 1 : 0;
+    if (k == 0 || k == n_entries || row != entries[k - 1] >> 32)
+      for (size_t r = prev_row; r <= row; r++)
+        graph.row_offsets[r] = k;
+    if (k < n_entries)
+      graph.col_indices[k] = static_cast<uint32_t>(entries[k]);
+  }
+  return graph;
+}
@@ -0,0 +1,23 @@
+#ifndef CSR_GRAPH_HPP
+#define CSR_GRAPH_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Symmetric adjacency matrix in compressed sparse row form: the neighbours
+// of node r are col_indices[row_offsets[r], row_offsets[r + 1]), ascending.
+// A pair (a, b) is stored in both rows, a pair (a, a) once.
+struct CsrGraph {
+  std::vector<uint64_t> row_offsets;
+  std::vector<uint32_t> col_indices;
+
+  size_t n_nodes() const { return row_offsets.size() - 1; }
+  size_t n_entries() const { return col_indices.size(); }
+};
+
+// Builds the graph of `n_nodes` nodes in parallel from unique undirected
+// edges packed as EdgeBuffer::pack(a, b), a <= b.
+CsrGraph buildCsrGraph(const std::vector<uint64_t>& edges, size_t n_nodes);
+
+#endif // CSR_GRAPH_HPP
@@ -0,0 +1,141 @@
+#ifndef DELTA_EDGES_HPP
+#define DELTA_EDGES_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Delta-varint edge format (".delta"), for pairs sorted by (i, j):
+//   header: "PJDELTA\0", n_nodes and n_edges as little-endian uint64;
+//   blocks: byte length and edge count of the block as little-endian
+//   uint32, then for every run of pairs with the same i: varint(i - previous
+//   i), varint(run length), varint(first j), varint(j - previous j) for the
+//   rest of the run. The previous i is 0 at the start of a block, so blocks
+//   are encoded and decoded independently. Varints are LEB128: 7 bits per
+//   byte, least significant first, high bit set on all but the last byte.
+// This header has no dependencies besides the standard library, so readers
+// can include it on its own.
+
+inline void appendVarint(std::string& buffer, uint64_t value) {
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<char>(value));
+}
+
+inline void appendUint32(std::string& buffer, uint32_t value) {
+  for (int byte = 0; byte < 4; byte++)
+    buffer.push_back(static_cast<char>(value >> (8 * byte)));
+}
+
+// Appends the block of `n_edges` sorted pairs packed as i << 32 | j.
+inline void appendDeltaBlock(std::string& buffer, const uint64_t* edges, size_t n_edges) {
+  size_t block_start = buffer.size();
+  appendUint32(buffer, 0);
+  appendUint32(buffer, n_edges);
+  uint64_t prev_i = 0;
+  for (size_t k = 0; k < n_edges;) {
+    uint64_t i = edges[k] >> 32;
+    size_t run_end = k + 1;
+    while (run_end < n_edges && edges[run_end] >> 32 == i)
+      run_end++;
+    appendVarint(buffer, i - prev_i);
+    appendVarint(buffer, run_end - k);
+    uint64_t prev_j = 0;
+    for (; k < run_end; k++) {
+      uint64_t j = edges[k] & 0xffffffffu;
+      appendVarint(buffer, j - prev_j);
+      prev_j = j;
+    }
+    prev_i = i;
+  }
+  uint32_t block_size = buffer.size() - block_start - 8;
+  for (int byte = 0; byte < 4; byte++)
+    buffer[block_start + byte] = static_cast<char>(block_size >> (8 * byte));
+}
+
+// Streams the pairs of a ".delta" file block by block:
+//   DeltaEdgeReader reader(file_name);
+//   uint32_t i, j;
+//   while (reader.next(i, j)) ...
+class DeltaEdgeReader {
+public:
+  explicit DeltaEdgeReader(const std::string& file_name) : file(file_name, std::ios::binary) {
+    unsigned char header[24];
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        std::memcmp(header, "PJDELTA\0", 8) != 0)
+      throw std::runtime_error("Not a delta edge file: " + file_name);
+    total_nodes = readUint64(header + 8);
+    total_edges = readUint64(header + 16);
+  }
+
+  uint64_t n_nodes() const { return total_nodes; }
+  uint64_t n_edges() const { return total_edges; }
+
+  // Reads the next pair; false after the last one.
+  bool next(uint32_t& i, uint32_t& j) {
+    while (run_left == 0) {
+      if (block_edges_left == 0 && !read_block())
+        return false;
+      current_i += readVarint();
+      run_left = readVarint();
+      current_j = 0;
+    }
+    current_j += readVarint();
+    run_left--;
+    block_edges_left--;
+    i = static_cast<uint32_t>(current_i);
+    j = static_cast<uint32_t>(current_j);
+    return true;
+  }
+
+private:
+  static uint64_t readUint64(const unsigned char* bytes) {
+    uint64_t value = 0;
+    for (int byte = 7; byte >= 0; byte--)
+      value = value << 8 | bytes[byte];
+    return value;
+  }
+
+  bool read_block() {
+    unsigned char sizes[8];
+    if (!file.read(reinterpret_cast<char*>(sizes), sizeof(sizes)))
+      return false;
+    uint32_t block_size = sizes[0] | sizes[1] << 8 | sizes[2] << 16 | static_cast<uint32_t>(sizes[3]) << 24;
+    block_edges_left = sizes[4] | sizes[5] << 8 | sizes[6] << 16 | static_cast<uint32_t>(sizes[7]) << 24;
+    block.resize(block_size);
+    if (!file.read(reinterpret_cast<char*>(block.data()), block_size))
+      throw std::runtime_error("Truncated delta edge file");
+    position = 0;
+    current_i = 0;
+    return true;
+  }
+
+  uint64_t readVarint() {
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+      if (position == block.size())
+        throw std::runtime_error("Corrupt delta edge block");
+      unsigned char byte = block[position++];
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return value;
+    }
+  }
+
+  std::ifstream file;
+  uint64_t total_nodes = 0;
+  uint64_t total_edges = 0;
+  std::vector<unsigned char> block;
+  size_t position = 0;
+  uint64_t block_edges_left = 0;
+  uint64_t run_left = 0;
+  uint64_t current_i = 0;
+  uint64_t current_j = 0;
+};
+
+#endif // DELTA_EDGES_HPP
@@ -5,17 +5,36 @@
 #include "hash_containers.hpp"
 
 void duplicates_search(
-  std::string file_name
+  std::string file_name,
+  const InputOptions& input,
+  const OutputOptions& output
 ) {
-  std::vector<std::string> strings;
-  str2int str2idx;
-  str2ints str2idxs;
-  readFile(file_name, strings, str2idx, true, str2idxs);
+  SequenceTable table;
+  readFile(file_name, input, table);
   std::string out_file_name = file_name + "_dupl";
+  if (output.duplicate_groups || output.mode != OutputMode::Edges) {
+    // every unique string is only paired with itself
+    std::unique_ptr<EdgeSummary> summary = openEdgeSummary(table, output);
+    EdgeBuffer out(nullptr, summary.get());
+    for (size_t u = 0; u < table.strings.size(); u++)
+      out.insert({u, u});
+    writeEdges(out_file_name, out, nullptr, summary.get(), table, output);
+    return;
+  }
+  if (output.format != OutputFormat::Text || output.sharded) {
+    // the pairs of the join are exactly the expanded groups of duplicates
+    OutputOptions expanded = output;
+    expanded.include_duplicates = true;
+    EdgeBuffer out;
+    for (size_t u = 0; u < table.strings.size(); u++)
+      out.insert({u, u});
+    writeEdges(out_file_name, out, nullptr, nullptr, table, expanded);
+    return;
+  }
   std::ofstream out_file;
   out_file.open(out_file_name);
-  for (const auto& entry : str2idxs) {
-    ints idxs = entry.second;
+  for (size_t u = 0; u < table.strings.size(); u++) {
+    std::span<const int> idxs = table.group(u);
     for (size_t i = 0; i < idxs.size(); i++) {
       out_file << idxs[i] << " " << idxs[i] << "\n";
       for (size_t j = i + 1; j < idxs.size(); j++) {
@@ -27,4 +46,4 @@ void duplicates_search(
   out_file.close();
 }
 
-#endif // DUPLICATES_SEARCH_HPP
\ No newline at end of file
+#endif // DUPLICATES_SEARCH_HPP
@@ -0,0 +1,118 @@
+#include "edge_buffer.hpp"
+#include "edge_stream.hpp"
+#include <algorithm>
+
+// Blocks of keys handled by one thread in a pass; nested calls run serially.
+static size_t n_key_blocks() {
+  return omp_in_parallel() ? 1 : 4 * omp_get_max_threads();
+}
+
+void radix_sort(std::vector<uint64_t>& keys, std::vector<uint64_t>& buffer) {
+  size_t n = keys.size();
+  if (n < 2)
+    return;
+  buffer.resize(n);
+  uint64_t first = keys[0], changing_bits = 0;
+  #pragma omp parallel for reduction(|:changing_bits) if(!omp_in_parallel())
+  for (size_t i = 1; i < n; i++)
+    changing_bits |= keys[i] ^ first;
+
+  size_t n_blocks = n_key_blocks();
+  size_t block_size = (n + n_blocks - 1) / n_blocks;
+  std::vector<size_t> offsets(n_blocks * 256);
+  for (int shift = 0; shift < 64; shift += 8) {
+    if (((changing_bits >> shift) & 0xff) == 0)
+      continue;
+    #pragma omp parallel if(!omp_in_parallel())
+    {
+      #pragma omp for schedule(static)
+      for (size_t block = 0; block < n_blocks; block++) {
+        size_t* counts = &offsets[block * 256];
+        std::fill(counts, counts + 256, 0);
+        for (size_t i = block * block_size; i < std::min((block + 1) * block_size, n); i++)
+          counts[(keys[i] >> shift) & 0xff]++;
+      }
+      #pragma omp single
+      {
+        size_t sum = 0;
+        for (size_t digit = 0; digit < 256; digit++)
+          for (size_t block = 0; block < n_blocks; block++) {
+            size_t count = offsets[block * 256 + digit];
+            offsets[block * 256 + digit] = sum;
+            sum += count;
+          }
+      }
+      #pragma omp for schedule(static)
+      for (size_t block = 0; block < n_blocks; block++) {
+        size_t* next = &offsets[block * 256];
+        for (size_t i = block * block_size; i < std::min((block + 1) * block_size, n); i++)
+          buffer[next[(keys[i] >> shift) & 0xff]++] = keys[i];
+      }
+    }
+    keys.swap(buffer);
+  }
+}
+
+void parallel_unique(std::vector<uint64_t>& keys, std::vector<uint64_t>& buffer) {
+  size_t n = keys.size();
+  if (n < 2)
+    return;
+  buffer.resize(n);
+  size_t n_blocks = n_key_blocks();
+  size_t block_size = (n + n_blocks - 1) / n_blocks;
+  std::vector<size_t> offsets(n_blocks + 1, 0);
+  #pragma omp parallel if(!omp_in_parallel())
+  {
+    #pragma omp for schedule(static)
+    for (size_t block = 0; block < n_blocks; block++)
+      for (size_t i = block * block_size; i < std::min((block + 1) * block_size, n); i++)
+        offsets[block + 1] += i == 0 || keys[i] != keys[i - 1];
+    #pragma omp single
+    for (size_t block = 0; block < n_blocks; block++)
+      offsets[block + 1] += offsets[block];
+    #pragma omp for schedule(static)
+    for (size_t block = 0; block < n_blocks; block++) {
+      size_t next = offsets[block];
+      for (size_t i = block * block_size; i < std::min((block + 1) * block_size, n); i++)
+        if (i == 0 || keys[i] != keys[i - 1])
+          buffer[next++] = keys[i];
+    }
+  }
+  buffer.resize(offsets[n_blocks]);
+  keys.swap(buffer);
+}
+
+void EdgeBuffer::flush_chunks(std::vector<std::vector<uint64_t>>& chunks) {
+  for (std::vector<uint64_t>& chunk : chunks)
+    stream->push(std::move(chunk));
+  chunks.clear();
+}
+
+void EdgeBuffer::finalize() {
+  if (stream != nullptr) {
+    for (ThreadEdges& edges : thread_edges)
+      flush_chunks(edges.chunks);
+    return;
+  }
+  std::vector<std::vector<uint64_t>*> chunks;
+  std::vector<size_t> chunk_offsets;
+  size_t total = sorted_edges.size();
+  for (ThreadEdges& edges : thread_edges)
+    for (std::vector<uint64_t>& chunk : edges.chunks) {
+      chunks.push_back(&chunk);
+      chunk_offsets.push_back(total);
+      total += chunk.size();
+    }
+  sorted_edges.resize(total);
+  #pragma omp parallel for schedule(dynamic) if(!omp_in_parallel())
+  for (size_t chunk = 0; chunk < chunks.size(); chunk++) {
+    std::copy(chunks[chunk]->begin(), chunks[chunk]->end(), sorted_edges.begin() + chunk_offsets[chunk]);
+    std::vector<uint64_t>().swap(*chunks[chunk]);
+  }
+  for (ThreadEdges& edges : thread_edges)
+    edges.chunks.clear();
+
+  std::vector<uint64_t> buffer;
+  radix_sort(sorted_edges, buffer);
+  parallel_unique(sorted_edges, buffer);
+}
@@ -0,0 +1,88 @@
+#ifndef EDGE_BUFFER_HPP
+#define EDGE_BUFFER_HPP
+
+#include <omp.h>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "edge_summary.hpp"
+
+class EdgeStream;
+
+// Number of pairs in one chunk of a thread's buffer.
+constexpr size_t EDGE_CHUNK_SIZE = 1 << 16;
+
+// Output pairs (i, j), packed into 64 bits as i << 32 | j. Every thread
+// appends to its own chunked buffer without locking; finalize() gathers the
+// chunks and sorts and deduplicates all pairs in parallel, after which the
+// pairs are read in ascending order. With a stream, full chunks are handed
+// to the stream's writer instead and nothing is kept; with a summary, pairs
+// are only counted or clustered.
+class EdgeBuffer {
+public:
+  // Created outside a parallel region the buffer serves the next parallel
+  // region, created inside one it serves the current team.
+  explicit EdgeBuffer(EdgeStream* stream = nullptr, EdgeSummary* summary = nullptr)
+    : thread_edges(omp_in_parallel() ? omp_get_num_threads() : omp_get_max_threads()),
+      stream(stream),
+      summary(summary) {}
+
+  static uint64_t pack(int i, int j) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(i)) << 32 | static_cast<uint32_t>(j);
+  }
+  static std::pair<int, int> unpack(uint64_t edge) {
+    return {static_cast<int>(edge >> 32), static_cast<int>(edge & 0xffffffffu)};
+  }
+
+  void insert(const std::pair<int, int>& pair) {
+    if (summary != nullptr) {
+      summary->add(pair.first, pair.second);
+      return;
+    }
+    std::vector<std::vector<uint64_t>>& chunks = thread_edges[omp_get_thread_num()].chunks;
+    if (chunks.empty() || chunks.back().size() == EDGE_CHUNK_SIZE) {
+      if (stream != nullptr && !chunks.empty())
+        flush_chunks(chunks);
+      chunks.emplace_back();
+      chunks.back().reserve(EDGE_CHUNK_SIZE);
+    }
+    chunks.back().push_back(pack(pair.first, pair.second));
+  }
+
+  // Whether the pair can be skipped without verification, see
+  // EdgeSummary::connected().
+  bool connected(int i, int j) {
+    return summary != nullptr && summary->connected(i, j);
+  }
+
+  // Moves all buffered pairs into one sorted array without duplicates, or
+  // hands the remaining chunks to the stream. Pairs inserted after
+  // finalize() are merged by the next call.
+  void finalize();
+
+  // Sorted unique pairs; valid after finalize().
+  const std::vector<uint64_t>& edges() const { return sorted_edges; }
+  size_t size() const { return sorted_edges.size(); }
+
+private:
+  struct alignas(64) ThreadEdges {
+    std::vector<std::vector<uint64_t>> chunks;
+  };
+  void flush_chunks(std::vector<std::vector<uint64_t>>& chunks);
+
+  std::vector<ThreadEdges> thread_edges;
+  std::vector<uint64_t> sorted_edges;
+  EdgeStream* stream;
+  EdgeSummary* summary;
+};
+
+// Sorts `keys` with a parallel least-significant-digit radix sort over 8-bit
+// digits. Digits equal in all keys (e.g. the high bits of small indices) are
+// skipped. `buffer` is used as scratch space.
+void radix_sort(std::vector<uint64_t>& keys, std::vector<uint64_t>& buffer);
+
+// Removes adjacent duplicates of the sorted `keys` in parallel.
+void parallel_unique(std::vector<uint64_t>& keys, std::vector<uint64_t>& buffer);
+
+#endif // EDGE_BUFFER_HPP
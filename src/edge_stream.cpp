@@ -0,0 +1,71 @@
+#include "edge_stream.hpp"
+#include "edge_buffer.hpp"
+#include "text_writer.hpp"
+#include <stdexcept>
+
+EdgeStream::EdgeStream(
+  const std::string& file_name,
+  const SequenceTable& table,
+  bool include_duplicates
+) : file_name(file_name),
+    out_file(file_name),
+    table(table),
+    include_duplicates(include_duplicates) {
+  if (!out_file)
+    throw std::runtime_error("Cannot open output file " + file_name);
+  writer = std::thread(&EdgeStream::write_loop, this);
+}
+
+EdgeStream::~EdgeStream() {
+  // a destructor must not throw, so write errors are reported by close() only
+  finish();
+}
+
+void EdgeStream::push(std::vector<uint64_t>&& chunk) {
+  queue.push(std::move(chunk));
+}
+
+void EdgeStream::finish() {
+  if (!writer.joinable())
+    return;
+  queue.close();
+  writer.join();
+  out_file.close();
+}
+
+void EdgeStream::close() {
+  finish();
+  if (!out_file)
+    throw std::runtime_error("Cannot write output file " + file_name);
+}
+
+void EdgeStream::write_loop() {
+  // pop waits for a chunk and fails once the queue is closed and drained
+  std::vector<uint64_t> chunk;
+  while (queue.pop(chunk))
+    if (!write_chunk(chunk)) {
+      // wakes waiting producers; their chunks are dropped from now on
+      queue.close();
+      return;
+    }
+}
+
+// Same lines as writeFile. With duplicates a pair of unique ids is expanded
+// to all pairs of their input lines.
+bool EdgeStream::write_chunk(const std::vector<uint64_t>& chunk) {
+  buffer.clear();
+  for (uint64_t edge : chunk) {
+    auto [i, j] = EdgeBuffer::unpack(edge);
+    if (!include_duplicates) {
+      appendLine(buffer, table.strings[i], table.strings[j]);
+      continue;
+    }
+    for (int str_idx1 : table.group(i))
+      for (int str_idx2 : table.group(j)) {
+        appendLine(buffer, str_idx1, str_idx2);
+        appendLine(buffer, str_idx2, str_idx1);
+      }
+  }
+  out_file.write(buffer.data(), buffer.size());
+  return static_cast<bool>(out_file);
+}
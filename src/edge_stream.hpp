@@ -0,0 +1,52 @@
+#ifndef EDGE_STREAM_HPP
+#define EDGE_STREAM_HPP
+
+#include <thread>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include "bounded_queue.hpp"
+#include "sequence_table.hpp"
+
+// Chunks of edges the queue may hold before producers wait for the writer.
+constexpr size_t STREAM_QUEUE_CHUNKS = 64;
+
+// Writes edges while the join is still running: workers push full chunks of
+// packed edges into a bounded queue and a dedicated writer thread formats
+// them into the output file. Every edge must be pushed exactly once; the
+// output is written in arrival order. A failed write stops the writer, later
+// chunks are dropped and close() reports the failure.
+class EdgeStream {
+public:
+  EdgeStream(
+    const std::string& file_name,
+    const SequenceTable& table,
+    bool include_duplicates
+  );
+  ~EdgeStream();
+
+  // Hands a chunk over to the writer; sleeps while the queue is full, so at
+  // most STREAM_QUEUE_CHUNKS chunks are held in memory.
+  void push(std::vector<uint64_t>&& chunk);
+
+  // Waits until every pushed chunk is written and closes the file; throws if
+  // any write or the final flush failed.
+  void close();
+
+private:
+  void finish();
+  void write_loop();
+  bool write_chunk(const std::vector<uint64_t>& chunk);
+
+  std::string file_name;
+  std::ofstream out_file;
+  const SequenceTable& table;
+  bool include_duplicates;
+  BoundedQueue<std::vector<uint64_t>> queue{STREAM_QUEUE_CHUNKS};
+  std::thread writer;
+  // text of the chunk being written
+  std::string buffer;
+};
+
+#endif // EDGE_STREAM_HPP
@@ -0,0 +1,108 @@
+#include "edge_summary.hpp"
+#include "edge_buffer.hpp"
+#include "text_writer.hpp"
+#include <fstream>
+
+EdgeSummary::EdgeSummary(
+  const SequenceTable& table,
+  bool include_duplicates,
+  OutputMode mode
+) : table(table),
+    include_duplicates(include_duplicates),
+    mode(mode),
+    weights(table.strings.size(), 1),
+    thread_counts(omp_in_parallel() ? omp_get_num_threads() : omp_get_max_threads()),
+    degrees(mode == OutputMode::Degrees ? table.strings.size() : 0),
+    components(mode == OutputMode::Components ? table.strings.size() : 0) {
+  if (include_duplicates) {
+    #pragma omp parallel for
+    for (size_t u = 0; u < table.strings.size(); u++)
+      weights[u] = table.group_size(u);
+  }
+}
+
+void EdgeSummary::add_sorted(const std::vector<uint64_t>& edges) {
+  #pragma omp parallel for
+  for (size_t k = 0; k < edges.size(); k++) {
+    auto [i, j] = EdgeBuffer::unpack(edges[k]);
+    add(i, j);
+  }
+}
+
+void EdgeSummary::write_components(const std::string& file_name) {
+  // nodes are input lines with duplicates, unique ids otherwise
+  size_t n_nodes = include_duplicates ? table.n_lines() : table.strings.size();
+  // roots are found (and their paths compressed) in parallel; labels are
+  // numbered in the order of their first node
+  std::vector<uint32_t> roots(table.strings.size());
+  #pragma omp parallel for
+  for (size_t u = 0; u < roots.size(); u++)
+    roots[u] = components.find(u);
+  std::vector<int> root_label(table.strings.size(), -1);
+  std::vector<int> labels(n_nodes);
+  std::vector<uint64_t> sizes;
+  for (size_t node = 0; node < n_nodes; node++) {
+    uint32_t root = roots[include_duplicates ? table.line_ids[node] : node];
+    if (root_label[root] < 0) {
+      root_label[root] = sizes.size();
+      sizes.push_back(0);
+    }
+    labels[node] = root_label[root];
+    sizes[labels[node]]++;
+  }
+
+  writeTextParallel(file_name + ".components", n_nodes, [&](size_t begin, size_t end, std::string& buffer) {
+    for (size_t i = begin; i < end; i++) {
+      if (include_duplicates)
+        appendInt(buffer, i);
+      else
+        buffer.append(table.strings[i]);
+      buffer.push_back(' ');
+      appendInt(buffer, labels[i]);
+      buffer.push_back('\n');
+    }
+  });
+  writeTextParallel(file_name + ".component_sizes", sizes.size(), [&](size_t begin, size_t end, std::string& buffer) {
+    for (size_t label = begin; label < end; label++) {
+      appendInt(buffer, sizes[label]);
+      buffer.push_back('\n');
+    }
+  });
+}
+
+void EdgeSummary::write(const std::string& file_name) {
+  if (mode == OutputMode::Components) {
+    write_components(file_name);
+    return;
+  }
+  if (degrees.empty()) {
+    uint64_t count = 0;
+    for (const ThreadCount& thread_count : thread_counts)
+      count += thread_count.count;
+    for (uint64_t weight : weights)
+      count += weight * (weight - 1) / 2;
+    std::ofstream count_file(file_name + ".count");
+    count_file << count << "\n";
+    count_file.close();
+    return;
+  }
+
+  if (!include_duplicates) {
+    writeTextParallel(file_name + ".degrees", table.strings.size(), [&](size_t begin, size_t end, std::string& buffer) {
+      for (size_t u = begin; u < end; u++) {
+        buffer.append(table.strings[u]);
+        buffer.push_back(' ');
+        appendInt(buffer, degrees[u].load());
+        buffer.push_back('\n');
+      }
+    });
+    return;
+  }
+  // every input line is also paired with the other lines of its group
+  writeTextParallel(file_name + ".degrees", table.n_lines(), [&](size_t begin, size_t end, std::string& buffer) {
+    for (size_t i = begin; i < end; i++) {
+      int id = table.line_ids[i];
+      appendLine(buffer, i, degrees[id].load() + table.group_size(id) - 1);
+    }
+  });
+}
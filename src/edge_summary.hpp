@@ -0,0 +1,86 @@
+#ifndef EDGE_SUMMARY_HPP
+#define EDGE_SUMMARY_HPP
+
+#include <omp.h>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "hash_containers.hpp"
+#include "concurrent_union_find.hpp"
+#include "sequence_table.hpp"
+
+// What is written about the pairs: the pairs themselves, or only their
+// number, the degree of every node or the connected components.
+enum class OutputMode {
+  Edges,
+  Count,
+  Degrees,
+  Components
+};
+
+// Number of pairs, degree of every node or connected components, computed
+// as pairs are found instead of keeping them. Pairs are pairs of unique
+// ids; nodes are unique strings, or input lines with duplicates: an id
+// stands for its whole group, so a pair of ids counts as all pairs of their
+// input lines. Self-pairs are
+// ignored; pairs within a group are added by write(). For counts every pair
+// must be added exactly once, components accept repeated pairs.
+class EdgeSummary {
+public:
+  EdgeSummary(
+    const SequenceTable& table,
+    bool include_duplicates,
+    OutputMode mode
+  );
+
+  void add(int i, int j) {
+    if (i == j)
+      return;
+    if (mode == OutputMode::Components) {
+      components.unite(i, j);
+      return;
+    }
+    uint64_t weight1 = weights[i], weight2 = weights[j];
+    thread_counts[omp_get_thread_num()].count += weight1 * weight2;
+    if (!degrees.empty()) {
+      degrees[i].fetch_add(weight2, std::memory_order_relaxed);
+      degrees[j].fetch_add(weight1, std::memory_order_relaxed);
+    }
+  }
+
+  // Whether adding the pair would change nothing: the strings are already
+  // in one component. Lets the joins skip verifying such pairs.
+  bool connected(int i, int j) {
+    return mode == OutputMode::Components && components.same(i, j);
+  }
+
+  // Adds sorted unique pairs packed by EdgeBuffer, in parallel.
+  void add_sorted(const std::vector<uint64_t>& edges);
+
+  // Writes the number of pairs to `file_name`.count; the degrees to
+  // `file_name`.degrees: "str degree" lines for unique strings, "idx degree"
+  // lines for input lines with duplicates; or "str label" ("idx label")
+  // lines to `file_name`.components and the number of nodes of every label
+  // to `file_name`.component_sizes. Labels are numbered in the order of
+  // their first node.
+  void write(const std::string& file_name);
+
+private:
+  struct alignas(64) ThreadCount {
+    uint64_t count = 0;
+  };
+
+  const SequenceTable& table;
+  bool include_duplicates;
+  OutputMode mode;
+  // input lines of every id with duplicates, 1 otherwise
+  std::vector<uint32_t> weights;
+  std::vector<ThreadCount> thread_counts;
+  std::vector<std::atomic<uint64_t>> degrees;
+  ConcurrentUnionFind components;
+
+  void write_components(const std::string& file_name);
+};
+
+#endif // EDGE_SUMMARY_HPP
@@ -1,66 +1,545 @@
 #include "file_io.hpp"
+#include "csr_graph.hpp"
+#include "input_parser.hpp"
+#include "text_writer.hpp"
+#include "delta_edges.hpp"
+#include <bit>
+#include <algorithm>
+#include <stdexcept>
+#include <atomic>
 
-void readFile(
-  const std::string& file_name,
-  std::vector<std::string>& strings,
-  str2int& str2idx,
-  bool include_duplicates,
-  str2ints& str2idxs
-) {
-  std::ifstream file(file_name);
-  if (!file) {
-    throw std::runtime_error("File does not exist");
+OutputFormat parseOutputFormat(const std::string& name) {
+  if (name == "text")
+    return OutputFormat::Text;
+  if (name == "binary")
+    return OutputFormat::Binary;
+  if (name == "npy")
+    return OutputFormat::Npy;
+  if (name == "csr")
+    return OutputFormat::Csr;
+  if (name == "delta")
+    return OutputFormat::Delta;
+  throw std::invalid_argument("Invalid output format, use `text`, `binary`, `npy`, `csr` or `delta`");
+}
+
+OutputMode parseOutputMode(const std::string& name) {
+  if (name == "edges")
+    return OutputMode::Edges;
+  if (name == "count")
+    return OutputMode::Count;
+  if (name == "degrees")
+    return OutputMode::Degrees;
+  if (name == "components")
+    return OutputMode::Components;
+  throw std::invalid_argument("Invalid output, use `edges`, `count`, `degrees` or `components`");
+}
+
+void readFile(const std::string& file_name, const InputOptions& input, SequenceTable& table) {
+  if (input.format == InputFormat::Lines && !isGzipFile(file_name)) {
+    MappedFile file(file_name);
+    std::string_view data = file.data();
+    table = buildSequenceTable(data, parseLines(data));
+    return;
   }
-  std::string line;
-  while (std::getline(file, line)) {
-    if (!line.empty() && line.back() == '\n')
-        line.pop_back();
-    if (line == "")
-      throw std::runtime_error("Empty line spotted in the input file\n");
-    strings.push_back(line);
+  std::string data;
+  std::vector<SequenceView> sequences;
+  readRecords(file_name, input, data, sequences);
+  table = buildSequenceTable(data, sequences);
+}
+
+// Pairs of input lines that the pairs of unique ids expand to with
+// duplicates. The expanded pairs are numbered, so that any range of them
+// can be produced on its own.
+struct DuplicateExpansion {
+  const std::vector<uint64_t>& edges;
+  const SequenceTable& table;
+  // expanded pairs before each edge
+  std::vector<size_t> offsets;
+
+  DuplicateExpansion(
+    const std::vector<uint64_t>& edges,
+    const SequenceTable& table
+  ) : edges(edges), table(table), offsets(edges.size() + 1, 0) {
+    #pragma omp parallel for
+    for (size_t k = 0; k < edges.size(); k++) {
+      auto [i, j] = EdgeBuffer::unpack(edges[k]);
+      offsets[k + 1] = table.group_size(i) * table.group_size(j);
+    }
+    for (size_t k = 0; k < edges.size(); k++)
+      offsets[k + 1] += offsets[k];
   }
 
-  str2idx.reserve(strings.size());
-  for (size_t i = 0; i < strings.size(); i++)
-    str2idx[strings[i]] = i;
-  if (include_duplicates) {
-    str2idxs.reserve(strings.size());
-    for (size_t i = 0; i < strings.size(); i++)
-      str2idxs[strings[i]].push_back(i);
+  size_t size() const { return offsets.back(); }
 
+  // Calls `visit(str_idx1, str_idx2)` for the expanded pairs [begin, end).
+  template <typename Visit>
+  void for_each(size_t begin, size_t end, Visit&& visit) const {
+    if (begin >= end)
+      return;
+    size_t k = std::upper_bound(offsets.begin(), offsets.end(), begin) - offsets.begin() - 1;
+    for (size_t pos = begin, p = begin - offsets[k]; pos < end; k++, p = 0) {
+      if (offsets[k + 1] == offsets[k])
+        continue;
+      auto [i, j] = EdgeBuffer::unpack(edges[k]);
+      std::span<const int> group1 = table.group(i);
+      std::span<const int> group2 = table.group(j);
+      size_t n_pairs = offsets[k + 1] - offsets[k];
+      for (; p < n_pairs && pos < end; p++, pos++)
+        visit(group1[p / group2.size()], group2[p % group2.size()]);
+    }
   }
-  file.close();
-}
+};
 
 void writeFile(
   const std::string& file_name,
-  const int_pair_set& out,
-  const std::vector<std::string>& strings,
-  str2ints& str2idxs, 
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
   bool include_duplicates
 ) {
+  if (!include_duplicates) {
+    writeTextParallel(file_name, edges.size(), [&](size_t begin, size_t end, std::string& buffer) {
+      for (size_t k = begin; k < end; k++) {
+        auto [i, j] = EdgeBuffer::unpack(edges[k]);
+        appendLine(buffer, table.strings[i], table.strings[j]);
+      }
+    });
+    return;
+  }
+  DuplicateExpansion expansion(edges, table);
+  writeTextParallel(file_name, expansion.size(), [&](size_t begin, size_t end, std::string& buffer) {
+    expansion.for_each(begin, end, [&](int str_idx1, int str_idx2) {
+      appendLine(buffer, str_idx1, str_idx2);
+      appendLine(buffer, str_idx2, str_idx1);
+    });
+  });
+}
+
+static uint32_t toLittleEndian(uint32_t value) {
+  if constexpr (std::endian::native == std::endian::big)
+    return (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+  return value;
+}
+
+static uint64_t toLittleEndian(uint64_t value) {
+  if constexpr (std::endian::native == std::endian::big)
+    return static_cast<uint64_t>(toLittleEndian(static_cast<uint32_t>(value))) << 32 |
+           toLittleEndian(static_cast<uint32_t>(value >> 32));
+  return value;
+}
+
+// Flat little-endian index pairs, the same pairs writeFile prints.
+static std::vector<uint32_t> collectIndexPairs(
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
+  bool include_duplicates
+) {
+  std::vector<uint32_t> pairs;
+  if (!include_duplicates) {
+    pairs.resize(2 * edges.size());
+    #pragma omp parallel for
+    for (size_t k = 0; k < edges.size(); k++) {
+      pairs[2 * k] = toLittleEndian(static_cast<uint32_t>(edges[k] >> 32));
+      pairs[2 * k + 1] = toLittleEndian(static_cast<uint32_t>(edges[k]));
+    }
+    return pairs;
+  }
+  DuplicateExpansion expansion(edges, table);
+  pairs.resize(4 * expansion.size());
+  size_t n_blocks = (expansion.size() + TEXT_BLOCK_ITEMS - 1) / TEXT_BLOCK_ITEMS;
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t block = 0; block < n_blocks; block++) {
+    size_t begin = block * TEXT_BLOCK_ITEMS;
+    uint32_t* next = &pairs[4 * begin];
+    expansion.for_each(begin, std::min(begin + TEXT_BLOCK_ITEMS, expansion.size()), [&](int str_idx1, int str_idx2) {
+      next[0] = next[3] = toLittleEndian(static_cast<uint32_t>(str_idx1));
+      next[1] = next[2] = toLittleEndian(static_cast<uint32_t>(str_idx2));
+      next += 4;
+    });
+  }
+  return pairs;
+}
+
+// Nodes of the output: input lines with duplicates, unique ids otherwise.
+static size_t nodeCount(const SequenceTable& table, bool include_duplicates) {
+  return include_duplicates ? table.n_lines() : table.strings.size();
+}
+
+// Writes the string of every node to `file_name`.nodes, one per line.
+static void writeNodeFile(const std::string& file_name, const SequenceTable& table, bool include_duplicates) {
+  size_t n_nodes = nodeCount(table, include_duplicates);
+  writeTextParallel(file_name + ".nodes", n_nodes, [&](size_t begin, size_t end, std::string& buffer) {
+    for (size_t node = begin; node < end; node++) {
+      buffer.append(table.strings[include_duplicates ? table.line_ids[node] : node]);
+      buffer.push_back('\n');
+    }
+  });
+}
+
+// NumPy format version 1.0: magic, header length and a dict literal padded
+// with spaces so that the data starts at a multiple of 64 bytes.
+static std::string npyHeader(size_t n_edges) {
+  std::string dict = "{'descr': '<u4', 'fortran_order': False, 'shape': (" +
+    std::to_string(n_edges) + ", 2), }";
+  size_t prefix_size = 10;
+  size_t padded_size = (prefix_size + dict.size() + 1 + 63) / 64 * 64;
+  dict.append(padded_size - prefix_size - dict.size() - 1, ' ');
+  dict.push_back('\n');
+  std::string header = "\x93NUMPY";
+  header.push_back(1);
+  header.push_back(0);
+  header.push_back(static_cast<char>(dict.size() & 0xff));
+  header.push_back(static_cast<char>(dict.size() >> 8));
+  return header + dict;
+}
+
+void writeBinaryFile(
+  const std::string& file_name,
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
+  bool include_duplicates,
+  OutputFormat format
+) {
+  std::vector<uint32_t> pairs = collectIndexPairs(edges, table, include_duplicates);
+  uint64_t n_edges = pairs.size() / 2;
+
   std::ofstream out_file;
-  out_file.open(file_name);
+  if (format == OutputFormat::Npy) {
+    out_file.open(file_name + ".npy", std::ios::binary);
+    std::string header = npyHeader(n_edges);
+    out_file.write(header.data(), header.size());
+  } else {
+    out_file.open(file_name + ".bin", std::ios::binary);
+    BinaryEdgesHeader header = {{'P', 'J', 'E', 'D', 'G', 'E', 'S', '\0'},
+                                toLittleEndian(static_cast<uint64_t>(nodeCount(table, include_duplicates))),
+                                toLittleEndian(n_edges)};
+    out_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+  if (!out_file)
+    throw std::runtime_error("Cannot open output file " + file_name);
+  out_file.write(reinterpret_cast<const char*>(pairs.data()), pairs.size() * sizeof(uint32_t));
+  out_file.close();
+  writeNodeFile(file_name, table, include_duplicates);
+}
+
+// Unique undirected index pairs (a, b), a <= b, packed as EdgeBuffer::pack.
+// With duplicates a string pair is expanded to all pairs of its input
+// indices, a string paired with itself to all pairs of its group.
+static std::vector<uint64_t> collectUndirectedEdges(
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
+  bool include_duplicates
+) {
   if (!include_duplicates)
-    for (const auto& pair : out)
-      out_file << strings[pair.first] << " " << strings[pair.second] << "\n";
-  else {
-    str_pair_set unique_out;
-    for (const auto& pair : out) {
-      std::string str1 = strings[pair.first], str2 = strings[pair.second];
-      if (str1 < str2)
-        unique_out.insert({str1, str2});
-      else
-        unique_out.insert({str2, str1});
+    return edges;
+  DuplicateExpansion expansion(edges, table);
+  std::vector<uint64_t> expanded(expansion.size());
+  size_t n_blocks = (expansion.size() + TEXT_BLOCK_ITEMS - 1) / TEXT_BLOCK_ITEMS;
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t block = 0; block < n_blocks; block++) {
+    size_t begin = block * TEXT_BLOCK_ITEMS;
+    uint64_t* next = &expanded[begin];
+    expansion.for_each(begin, std::min(begin + TEXT_BLOCK_ITEMS, expansion.size()), [&](int str_idx1, int str_idx2) {
+      *next++ = EdgeBuffer::pack(std::min(str_idx1, str_idx2), std::max(str_idx1, str_idx2));
+    });
+  }
+  // a group paired with itself yields (x, y) and (y, x)
+  std::vector<uint64_t> buffer;
+  radix_sort(expanded, buffer);
+  parallel_unique(expanded, buffer);
+  return expanded;
+}
+
+void writeCsrFiles(
+  const std::string& file_name,
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
+  bool include_duplicates
+) {
+  size_t n_edges;
+  CsrGraph graph;
+  {
+    std::vector<uint64_t> undirected = collectUndirectedEdges(edges, table, include_duplicates);
+    n_edges = undirected.size();
+    graph = buildCsrGraph(undirected, nodeCount(table, include_duplicates));
+  }
+
+  // symmetric pattern matrix: the lower triangle, 1-based; item 0 is the
+  // header, item r + 1 the entries of row r
+  writeTextParallel(file_name + ".mtx", graph.n_nodes() + 1, [&](size_t begin, size_t end, std::string& buffer) {
+    for (size_t item = begin; item < end; item++) {
+      if (item == 0) {
+        buffer.append("%%MatrixMarket matrix coordinate pattern symmetric\n");
+        appendInt(buffer, graph.n_nodes());
+        buffer.push_back(' ');
+        appendLine(buffer, graph.n_nodes(), n_edges);
+        continue;
+      }
+      size_t row = item - 1;
+      for (uint64_t k = graph.row_offsets[row]; k < graph.row_offsets[row + 1] && graph.col_indices[k] <= row; k++)
+        appendLine(buffer, row + 1, graph.col_indices[k] + 1);
     }
-    for (auto pair : unique_out) {
-      std::string str1 = pair.first, str2 = pair.second;
-      for (auto str_idx1 : str2idxs[str1])
-        for (auto str_idx2 : str2idxs[str2]) {
-          out_file << str_idx1 << " " << str_idx2 << "\n";
-          out_file << str_idx2 << " " << str_idx1 << "\n";
-        }
+  });
+
+  std::ofstream csr_file(file_name + ".csr", std::ios::binary);
+  if (!csr_file)
+    throw std::runtime_error("Cannot open output file " + file_name + ".csr");
+  BinaryEdgesHeader header = {{'P', 'J', 'C', 'S', 'R', '\0', '\0', '\0'},
+                              toLittleEndian(static_cast<uint64_t>(graph.n_nodes())),
+                              toLittleEndian(static_cast<uint64_t>(graph.n_entries()))};
+  csr_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (uint64_t& offset : graph.row_offsets)
+    offset = toLittleEndian(offset);
+  for (uint32_t& col : graph.col_indices)
+    col = toLittleEndian(col);
+  csr_file.write(reinterpret_cast<const char*>(graph.row_offsets.data()), graph.row_offsets.size() * sizeof(uint64_t));
+  csr_file.write(reinterpret_cast<const char*>(graph.col_indices.data()), graph.col_indices.size() * sizeof(uint32_t));
+  csr_file.close();
+
+  writeNodeFile(file_name, table, include_duplicates);
+}
+
+std::unique_ptr<EdgeStream> openEdgeStream(
+  const std::string& file_name,
+  const SequenceTable& table,
+  const OutputOptions& output
+) {
+  if (!output.stream || output.format != OutputFormat::Text || output.duplicate_groups ||
+      output.mode != OutputMode::Edges || output.sharded)
+    return nullptr;
+  return std::make_unique<EdgeStream>(file_name, table, output.include_duplicates);
+}
+
+// Pairs of the output numbered so that any range of them can be produced
+// on its own: the edges, or with duplicates the expanded pairs, each in
+// both directions as in writeFile.
+struct OutputPairs {
+  const std::vector<uint64_t>& edges;
+  std::unique_ptr<DuplicateExpansion> expansion;
+
+  OutputPairs(
+    const std::vector<uint64_t>& edges,
+    const SequenceTable& table,
+    bool include_duplicates
+  ) : edges(edges),
+      expansion(include_duplicates ? std::make_unique<DuplicateExpansion>(edges, table) : nullptr) {}
+
+  size_t size() const { return expansion ? expansion->size() : edges.size(); }
+  size_t pairs_per_item() const { return expansion ? 2 : 1; }
+
+  // Calls `visit(idx1, idx2)` for every pair of the items [begin, end).
+  template <typename Visit>
+  void for_each(size_t begin, size_t end, Visit&& visit) const {
+    if (expansion) {
+      expansion->for_each(begin, end, [&](int str_idx1, int str_idx2) {
+        visit(str_idx1, str_idx2);
+        visit(str_idx2, str_idx1);
+      });
+      return;
+    }
+    for (size_t k = begin; k < end; k++) {
+      auto [i, j] = EdgeBuffer::unpack(edges[k]);
+      visit(i, j);
+    }
+  }
+};
+
+static std::string shardName(const std::string& file_name, size_t shard, OutputFormat format) {
+  std::string number = std::to_string(shard);
+  std::string name = file_name + ".part-" + std::string(number.size() < 4 ? 4 - number.size() : 0, '0') + number;
+  if (format == OutputFormat::Binary)
+    return name + ".bin";
+  if (format == OutputFormat::Npy)
+    return name + ".npy";
+  return name;
+}
+
+void writeEdgeShards(
+  const std::string& file_name,
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
+  bool include_duplicates,
+  OutputFormat format,
+  size_t n_shards
+) {
+  if (format == OutputFormat::Csr || format == OutputFormat::Delta)
+    throw std::invalid_argument("The csr and delta formats cannot be written in shards");
+  OutputPairs pairs(edges, table, include_duplicates);
+  std::vector<std::string> shard_names(n_shards);
+  std::vector<uint64_t> shard_sizes(n_shards);
+  std::atomic<bool> failed{false};
+  #pragma omp parallel for schedule(static, 1)
+  for (size_t shard = 0; shard < n_shards; shard++) {
+    size_t begin = pairs.size() * shard / n_shards;
+    size_t end = pairs.size() * (shard + 1) / n_shards;
+    shard_names[shard] = shardName(file_name, shard, format);
+    shard_sizes[shard] = (end - begin) * pairs.pairs_per_item();
+    std::ofstream shard_file(shard_names[shard], std::ios::binary);
+    if (!shard_file) {
+      failed = true;
+      continue;
+    }
+    if (format == OutputFormat::Npy) {
+      std::string header = npyHeader(shard_sizes[shard]);
+      shard_file.write(header.data(), header.size());
+    } else if (format == OutputFormat::Binary) {
+      BinaryEdgesHeader header = {{'P', 'J', 'E', 'D', 'G', 'E', 'S', '\0'},
+                                  toLittleEndian(static_cast<uint64_t>(nodeCount(table, include_duplicates))),
+                                  toLittleEndian(shard_sizes[shard])};
+      shard_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    std::string text;
+    std::vector<uint32_t> values;
+    for (size_t block = begin; block < end; block += TEXT_BLOCK_ITEMS) {
+      size_t block_end = std::min(block + TEXT_BLOCK_ITEMS, end);
+      if (format == OutputFormat::Text) {
+        text.clear();
+        pairs.for_each(block, block_end, [&](int idx1, int idx2) {
+          if (include_duplicates)
+            appendLine(text, idx1, idx2);
+          else
+            appendLine(text, table.strings[idx1], table.strings[idx2]);
+        });
+        shard_file.write(text.data(), text.size());
+      } else {
+        values.clear();
+        pairs.for_each(block, block_end, [&](int idx1, int idx2) {
+          values.push_back(toLittleEndian(static_cast<uint32_t>(idx1)));
+          values.push_back(toLittleEndian(static_cast<uint32_t>(idx2)));
+        });
+        shard_file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(uint32_t));
       }
+    }
+    shard_file.close();
+    if (!shard_file)
+      failed = true;
   }
-  out_file.close();
-}
\ No newline at end of file
+  if (failed)
+    throw std::runtime_error("Cannot write the output shards of " + file_name);
+
+  const char* format_names[] = {"text", "binary", "npy", "csr", "delta"};
+  std::ofstream manifest(file_name + ".manifest");
+  manifest << "format " << format_names[static_cast<int>(format)] << "\n";
+  manifest << "nodes " << nodeCount(table, include_duplicates) << "\n";
+  manifest << "pairs " << pairs.size() * pairs.pairs_per_item() << "\n";
+  manifest << "shards " << n_shards << "\n";
+  for (size_t shard = 0; shard < n_shards; shard++) {
+    std::string name = shard_names[shard].substr(shard_names[shard].find_last_of('/') + 1);
+    manifest << name << " " << shard_sizes[shard] << "\n";
+  }
+  manifest.close();
+  if (format != OutputFormat::Text)
+    writeNodeFile(file_name, table, include_duplicates);
+}
+
+void writeDeltaFile(
+  const std::string& file_name,
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
+  bool include_duplicates
+) {
+  // expanded pairs are not sorted
+  std::vector<uint64_t> expanded;
+  if (include_duplicates) {
+    OutputPairs pairs(edges, table, true);
+    expanded.resize(pairs.size() * pairs.pairs_per_item());
+    size_t n_blocks = (pairs.size() + TEXT_BLOCK_ITEMS - 1) / TEXT_BLOCK_ITEMS;
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t block = 0; block < n_blocks; block++) {
+      size_t begin = block * TEXT_BLOCK_ITEMS;
+      uint64_t* next = &expanded[begin * pairs.pairs_per_item()];
+      pairs.for_each(begin, std::min(begin + TEXT_BLOCK_ITEMS, pairs.size()), [&](int idx1, int idx2) {
+        *next++ = EdgeBuffer::pack(idx1, idx2);
+      });
+    }
+    std::vector<uint64_t> buffer;
+    radix_sort(expanded, buffer);
+  }
+  const std::vector<uint64_t>& sorted_edges = include_duplicates ? expanded : edges;
+
+  BinaryEdgesHeader header = {{'P', 'J', 'D', 'E', 'L', 'T', 'A', '\0'},
+                              toLittleEndian(static_cast<uint64_t>(nodeCount(table, include_duplicates))),
+                              toLittleEndian(static_cast<uint64_t>(sorted_edges.size()))};
+  writeTextParallel(file_name + ".delta", sorted_edges.size(), [&](size_t begin, size_t end, std::string& buffer) {
+    appendDeltaBlock(buffer, sorted_edges.data() + begin, end - begin);
+  }, std::string_view(reinterpret_cast<const char*>(&header), sizeof(header)));
+  writeNodeFile(file_name, table, include_duplicates);
+}
+
+// Writes the pairs in `format`, without streaming, to one file or to
+// `n_shards` shards.
+static void writeEdgeFiles(
+  const std::string& file_name,
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
+  bool include_duplicates,
+  OutputFormat format,
+  size_t n_shards
+) {
+  if (n_shards > 0)
+    writeEdgeShards(file_name, edges, table, include_duplicates, format, n_shards);
+  else if (format == OutputFormat::Text)
+    writeFile(file_name, edges, table, include_duplicates);
+  else if (format == OutputFormat::Csr)
+    writeCsrFiles(file_name, edges, table, include_duplicates);
+  else if (format == OutputFormat::Delta)
+    writeDeltaFile(file_name, edges, table, include_duplicates);
+  else
+    writeBinaryFile(file_name, edges, table, include_duplicates, format);
+}
+
+void writeDuplicateGroups(
+  const std::string& file_name,
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
+  OutputFormat format,
+  size_t n_shards
+) {
+  // the pairs already are pairs of unique ids
+  writeEdgeFiles(file_name, edges, table, false, format, n_shards);
+  if (format == OutputFormat::Text)
+    writeNodeFile(file_name, table, false);
+  writeTextParallel(file_name + ".group_sizes", table.strings.size(), [&](size_t begin, size_t end, std::string& buffer) {
+    for (size_t u = begin; u < end; u++) {
+      appendInt(buffer, table.group_size(u));
+      buffer.push_back('\n');
+    }
+  });
+  writeTextParallel(file_name + ".membership", table.n_lines(), [&](size_t begin, size_t end, std::string& buffer) {
+    for (size_t i = begin; i < end; i++) {
+      appendInt(buffer, table.line_ids[i]);
+      buffer.push_back('\n');
+    }
+  });
+}
+
+std::unique_ptr<EdgeSummary> openEdgeSummary(
+  const SequenceTable& table,
+  const OutputOptions& output
+) {
+  if (output.mode == OutputMode::Edges)
+    return nullptr;
+  return std::make_unique<EdgeSummary>(table, output.include_duplicates, output.mode);
+}
+
+void writeEdges(
+  const std::string& file_name,
+  EdgeBuffer& out,
+  EdgeStream* stream,
+  EdgeSummary* summary,
+  const SequenceTable& table,
+  const OutputOptions& output
+) {
+  out.finalize();
+  // one shard per worker thread
+  size_t n_shards = output.sharded ? omp_get_max_threads() : 0;
+  if (summary != nullptr) {
+    // empty unless the pairs were kept for deduplication
+    summary->add_sorted(out.edges());
+    summary->write(file_name);
+  } else if (stream != nullptr)
+    stream->close();
+  else if (output.duplicate_groups)
+    writeDuplicateGroups(file_name, out.edges(), table, output.format, n_shards);
+  else
+    writeEdgeFiles(file_name, out.edges(), table, output.include_duplicates, output.format, n_shards);
+}
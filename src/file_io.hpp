@@ -5,22 +5,153 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <cstdint>
 #include "hash_containers.hpp"
+#include "edge_buffer.hpp"
+#include "edge_stream.hpp"
+#include "sequence_table.hpp"
+#include "record_reader.hpp"
+#include <memory>
 
-void readFile(
+// Layout of the output file. Binary formats hold index pairs; the strings
+// are written to a companion ".nodes" file, one per line in index order.
+enum class OutputFormat {
+  Text,    // "str1 str2" lines, or "idx1 idx2" lines with duplicates
+  Binary,  // ".bin": BinaryEdgesHeader followed by little-endian uint32 pairs
+  Npy,     // ".npy": NumPy array of shape (n_edges, 2) and dtype <u4
+  Csr,     // ".csr" CSR blob and ".mtx" Matrix Market file, see writeCsrFiles
+  Delta    // ".delta": sorted pairs in delta-varint blocks, see delta_edges.hpp
+};
+
+// Header of the ".bin", ".csr" and ".delta" formats, all fields
+// little-endian.
+struct BinaryEdgesHeader {
+  char magic[8];  // "PJEDGES\0", "PJCSR\0\0\0" or "PJDELTA\0"
+  uint64_t n_nodes;
+  uint64_t n_edges;  // pairs, or stored entries of the CSR matrix
+};
+
+// How the pairs found by a join are written.
+struct OutputOptions {
+  bool include_duplicates = false;
+  // with include_duplicates: write pairs of unique strings plus the groups
+  // of duplicates instead of expanding the groups, see writeDuplicateGroups
+  bool duplicate_groups = false;
+  // write pairs from a writer thread while the join runs, in arrival order;
+  // text format without duplicate groups only
+  bool stream = false;
+  OutputFormat format = OutputFormat::Text;
+  OutputMode mode = OutputMode::Edges;
+  // write one shard per worker thread plus a manifest, see writeEdgeShards
+  bool sharded = false;
+};
+
+// Parses `text`, `binary`, `npy`, `csr` or `delta`.
+OutputFormat parseOutputFormat(const std::string& name);
+
+// Parses `edges`, `count`, `degrees` or `components`.
+OutputMode parseOutputMode(const std::string& name);
+
+// Reads the sequences of the input in `input.format` and deduplicates them,
+// see buildSequenceTable. Uncompressed files of one sequence per line are
+// mapped and split in parallel; other inputs are streamed by readRecords.
+void readFile(const std::string& file_name, const InputOptions& input, SequenceTable& table);
+
+void writeFile(
+  const std::string& file_name,
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
+  bool include_duplicates
+);
+
+// Writes the pairs as little-endian uint32 index pairs in `format` to
+// `file_name` plus the extension, and the strings to `file_name`.nodes.
+// Indices are input lines when `include_duplicates` is set, as in the text
+// format with duplicates, and unique ids otherwise.
+void writeBinaryFile(
   const std::string& file_name,
-  std::vector<std::string>& strings,
-  str2int& str2idx,
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
   bool include_duplicates,
-  str2ints& str2idxs
+  OutputFormat format
 );
 
-void writeFile(
+// Writes the symmetric adjacency matrix of the pairs (indices as in
+// writeBinaryFile) to `file_name`.csr: the header, n_nodes + 1 uint64 row
+// offsets and n_edges uint32 column indices; to `file_name`.mtx as a Matrix
+// Market symmetric pattern matrix (lower triangle); and the strings to
+// `file_name`.nodes.
+void writeCsrFiles(
   const std::string& file_name,
-  const int_pair_set& out,
-  const std::vector<std::string>& strings,
-  str2ints& str2idxs, 
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
   bool include_duplicates
 );
 
+// Writes the pairs of unique strings in `format` (with unique ids as the
+// indices), `file_name`.nodes with the unique string of every id,
+// `file_name`.group_sizes with the number of input lines of every id and
+// `file_name`.membership with the id of every input line. Ids follow the
+// order of the first input line of every unique string.
+void writeDuplicateGroups(
+  const std::string& file_name,
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
+  OutputFormat format,
+  size_t n_shards
+);
+
+// Writes the pairs sorted by (i, j) to `file_name`.delta (indices as in
+// writeBinaryFile), with blocks encoded in parallel, and the strings to
+// `file_name`.nodes. Read it with DeltaEdgeReader.
+void writeDeltaFile(
+  const std::string& file_name,
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
+  bool include_duplicates
+);
+
+// Writes the pairs in `format` (text, binary or npy) split into `n_shards`
+// files `file_name`.part-0000, `file_name`.part-0001, ... (plus the
+// format's extension), written independently by the worker threads. Shards
+// of the binary formats are complete files with their own header.
+// `file_name`.manifest lists the format, the number of nodes and pairs and
+// every shard with its number of pairs; the binary formats also get
+// `file_name`.nodes.
+void writeEdgeShards(
+  const std::string& file_name,
+  const std::vector<uint64_t>& edges,
+  const SequenceTable& table,
+  bool include_duplicates,
+  OutputFormat format,
+  size_t n_shards
+);
+
+// Stream for the join's output when streaming is requested, nullptr otherwise.
+std::unique_ptr<EdgeStream> openEdgeStream(
+  const std::string& file_name,
+  const SequenceTable& table,
+  const OutputOptions& output
+);
+
+// Summary of the join's pairs when only counts or components are
+// requested, nullptr otherwise. The pairs of methods that may find a pair
+// more than once must not be counted directly: writeEdges() adds them after
+// deduplication.
+std::unique_ptr<EdgeSummary> openEdgeSummary(
+  const SequenceTable& table,
+  const OutputOptions& output
+);
+
+// Finishes the join's output: flushes the stream, writes the summary, or
+// sorts the buffered pairs and writes them in the requested format.
+void writeEdges(
+  const std::string& file_name,
+  EdgeBuffer& out,
+  EdgeStream* stream,
+  EdgeSummary* summary,
+  const SequenceTable& table,
+  const OutputOptions& output
+);
+
 #endif // FILE_IO_HPP
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef GAPPED_VIEW_HPP
+#define GAPPED_VIEW_HPP
+
+#include <string>
+#include <string_view>
+
+// Non-owning view of a string with one gap cut out of it: the characters of
+// `prefix` followed by the characters of `suffix`. A contiguous substring
+// has an empty suffix. Trimming a string to a GappedView never allocates.
+struct GappedView {
+  std::string_view prefix;
+  std::string_view suffix;
+
+  GappedView() = default;
+  GappedView(const std::string& str) : prefix(str) {}
+  GappedView(std::string_view str) : prefix(str) {}
+  GappedView(std::string_view prefix, std::string_view suffix) : prefix(prefix), suffix(suffix) {}
+
+  size_t size() const { return prefix.size() + suffix.size(); }
+  bool contiguous() const { return suffix.empty(); }
+  char operator[](size_t i) const {
+    return i < prefix.size() ? prefix[i] : suffix[i - prefix.size()];
+  }
+
+  // Copies the viewed characters into `out`, reusing its capacity.
+  void copy_to(std::string& out) const {
+    out.assign(prefix);
+    out.append(suffix);
+  }
+  std::string str() const {
+    std::string out;
+    copy_to(out);
+    return out;
+  }
+};
+
+#endif // GAPPED_VIEW_HPP
@@ -20,4 +20,12 @@ using int_pair_set = gtl::parallel_flat_hash_set_m<std::pair<int, int>>;
 using str_pair_set = ankerl::unordered_dense::set<std::pair<std::string, std::string>>;
 using str_pair_set = ankerl::unordered_dense::set<std::pair<std::string, std::string>>;
 
+// Shard of `key` among `n_shards` hash maps. The maps take their fingerprints
+// from the low bits of the same hash and their bucket index from the high
+// ones, so the shard comes from the upper half.
+template <typename Key>
+inline size_t hash_shard(const Key& key, size_t n_shards) {
+  return (ankerl::unordered_dense::hash<Key>{}(key) >> 32) % n_shards;
+}
+
 #endif // HASHMAP_CONTAINERS_HPP
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "input_parser.hpp"
+#include <omp.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+MappedFile::MappedFile(const std::string& file_name) {
+  int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("File does not exist");
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) != 0) {
+    ::close(fd);
+    throw std::runtime_error("Cannot read file " + file_name);
+  }
+  size = file_stat.st_size;
+  if (size > 0) {
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("Cannot map file " + file_name);
+    }
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+    bytes = static_cast<const char*>(mapping);
+  }
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (bytes != nullptr)
+    ::munmap(const_cast<char*>(bytes), size);
+}
+
+// First line start at or after `pos`.
+static size_t lineStart(std::string_view data, size_t pos) {
+  if (pos == 0 || pos >= data.size())
+    return std::min(pos, data.size());
+  const void* newline = std::memchr(data.data() + pos - 1, '\n', data.size() - pos + 1);
+  return newline == nullptr ? data.size() : static_cast<const char*>(newline) - data.data() + 1;
+}
+
+// Calls `visit(offset, length)` for the lines starting in [begin, end).
+template <typename Visit>
+static void forEachLine(std::string_view data, size_t begin, size_t end, Visit&& visit) {
+  for (size_t pos = begin; pos < end;) {
+    const void* newline = std::memchr(data.data() + pos, '\n', data.size() - pos);
+    size_t line_end = newline == nullptr ? data.size() : static_cast<const char*>(newline) - data.data();
+    visit(pos, line_end - pos);
+    pos = line_end + 1;
+  }
+}
+
+std::vector<SequenceView> parseLines(std::string_view data) {
+  size_t n_chunks = (data.size() + PARSE_CHUNK_SIZE - 1) / PARSE_CHUNK_SIZE;
+  std::vector<size_t> chunk_begin(n_chunks + 1);
+  #pragma omp parallel for
+  for (size_t chunk = 0; chunk <= n_chunks; chunk++)
+    chunk_begin[chunk] = lineStart(data, chunk * PARSE_CHUNK_SIZE);
+
+  // lines per chunk, then their positions in the result
+  std::vector<size_t> line_offsets(n_chunks + 1, 0);
+  std::atomic<bool> empty_line{false};
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t chunk = 0; chunk < n_chunks; chunk++)
+    forEachLine(data, chunk_begin[chunk], chunk_begin[chunk + 1], [&](size_t, size_t length) {
+      line_offsets[chunk + 1]++;
+      if (length == 0)
+        empty_line = true;
+    });
+  if (empty_line)
+    throw std::runtime_error("Empty line spotted in the input file\n");
+  for (size_t chunk = 0; chunk < n_chunks; chunk++)
+    line_offsets[chunk + 1] += line_offsets[chunk];
+
+  std::vector<SequenceView> lines(line_offsets[n_chunks]);
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t chunk = 0; chunk < n_chunks; chunk++) {
+    size_t next = line_offsets[chunk];
+    forEachLine(data, chunk_begin[chunk], chunk_begin[chunk + 1], [&](size_t offset, size_t length) {
+      lines[next++] = {offset, static_cast<uint32_t>(length)};
+    });
+  }
+  return lines;
+}
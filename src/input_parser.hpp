@@ -0,0 +1,38 @@
+#ifndef INPUT_PARSER_HPP
+#define INPUT_PARSER_HPP
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string& file_name);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  std::string_view data() const { return {bytes, size}; }
+
+private:
+  const char* bytes = nullptr;
+  size_t size = 0;
+};
+
+// Line of the input: `length` bytes at `offset` of the mapping.
+struct SequenceView {
+  uint64_t offset;
+  uint32_t length;
+};
+
+// Input bytes per parsing task.
+constexpr size_t PARSE_CHUNK_SIZE = 1 << 22;
+
+// Splits `data` into lines in parallel: chunks are aligned to the next
+// newline and every chunk emits the lines that start in it. A missing final
+// newline is accepted; empty lines are not.
+std::vector<SequenceView> parseLines(std::string_view data);
+
+#endif // INPUT_PARSER_HPP
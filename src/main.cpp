@@ -10,6 +10,7 @@
 
 size_t SIM_SEARCH_THRESHOLD = 50;
 size_t OMP_SIM_SEARCH_THRESHOLD = 20'000;
+size_t SPLIT_SIM_SEARCH_THRESHOLD = 2'000;
 
 struct Options {
   std::string file_name;
@@ -17,6 +18,12 @@ struct Options {
   char metric;
   std::string method;
   bool include_duplicates;
+  bool duplicate_groups = false;
+  bool stream = false;
+  OutputFormat output_format = OutputFormat::Text;
+  OutputMode output_mode = OutputMode::Edges;
+  bool sharded = false;
+  InputOptions input;
 };
 
 Options parse_arguments(int argc, char* argv[]) {
@@ -30,10 +37,16 @@ Options parse_arguments(int argc, char* argv[]) {
     {"metric_type", 1, 0, 't'},
     {"method", 1, 0, 'm'},
     {"include_duplicates", 1, 0, 'd'},
+    {"stream", 1, 0, 's'},
+    {"output_format", 1, 0, 'o'},
+    {"output", 1, 0, 'r'},
+    {"sharded", 1, 0, 'p'},
+    {"input_format", 1, 0, 'i'},
+    {"column", 1, 0, 'k'},
     {0, 0, 0, 0}
   };
 
-  while ((opt = getopt_long(argc, argv, "f:c:t:m:d:", long_options, &option_index)) != -1) {
+  while ((opt = getopt_long(argc, argv, "f:c:t:m:d:s:o:r:p:i:k:", long_options, &option_index)) != -1) {
     switch (opt) {
       case 'f':
         options.file_name = optarg;
@@ -57,8 +70,39 @@ Options parse_arguments(int argc, char* argv[]) {
           options.include_duplicates = true;
         else if (std::string(optarg) == "false")
           options.include_duplicates = false;
+        else if (std::string(optarg) == "groups") {
+          options.include_duplicates = true;
+          options.duplicate_groups = true;
+        } else
+          throw std::runtime_error("Invalid value for include_duplicates, use `true`, `false` or `groups`");
+        break;
+      case 's':
+        if (std::string(optarg) == "true")
+          options.stream = true;
+        else if (std::string(optarg) == "false")
+          options.stream = false;
+        else
+          throw std::runtime_error("Invalid value for stream, use `true` or `false`");
+        break;
+      case 'o':
+        options.output_format = parseOutputFormat(optarg);
+        break;
+      case 'r':
+        options.output_mode = parseOutputMode(optarg);
+        break;
+      case 'p':
+        if (std::string(optarg) == "true")
+          options.sharded = true;
+        else if (std::string(optarg) == "false")
+          options.sharded = false;
         else
-          throw std::runtime_error("Invalid value for include_duplicates, use `true` or `false`");
+          throw std::runtime_error("Invalid value for sharded, use `true` or `false`");
+        break;
+      case 'i':
+        options.input.format = parseInputFormat(optarg);
+        break;
+      case 'k':
+        options.input.column = optarg;
         break;
       default:
         throw std::runtime_error("Unknown option");
@@ -71,18 +115,29 @@ Options parse_arguments(int argc, char* argv[]) {
 int main(int argc, char* argv[]) {
   if (argc < 11)
     throw std::runtime_error(
-      "arguments: --file_name <file_name> --cutoff <cutoff> --metric_type <metric> --method <method> --include_duplicates <true/false>");
+      "arguments: --file_name <file_name> --cutoff <cutoff> --metric_type <metric> --method <method> --include_duplicates <true/false/groups> [--stream <true/false>] [--output_format <text/binary/npy/csr/delta>] [--output <edges/count/degrees/components>] [--sharded <true/false>] [--input_format <lines/tsv/fasta>] [--column <column>]");
 
   Options opt = parse_arguments(argc, argv);
+  OutputOptions output;
+  output.include_duplicates = opt.include_duplicates;
+  output.duplicate_groups = opt.duplicate_groups;
+  output.stream = opt.stream;
+  output.format = opt.output_format;
+  output.mode = opt.output_mode;
+  output.sharded = opt.sharded;
+  if (output.sharded && (output.format == OutputFormat::Csr || output.format == OutputFormat::Delta))
+    throw std::runtime_error("The csr and delta formats cannot be written in shards");
+  if (output.stream && opt.cutoff != 0 && opt.method == "pattern")
+    throw std::runtime_error("The pattern method finds pairs more than once and cannot stream them");
   if (opt.cutoff == 0) {
-    duplicates_search(opt.file_name);
+    duplicates_search(opt.file_name, opt.input, output);
   } else {
     if (opt.method == "pattern")
-      return sim_search_patterns(opt.file_name, opt.cutoff, opt.metric, opt.include_duplicates);
+      return sim_search_patterns(opt.file_name, opt.cutoff, opt.metric, opt.input, output);
     else if (opt.method == "semi_pattern")
-      return sim_search_semi_patterns(opt.file_name, opt.cutoff, opt.metric, opt.include_duplicates);
+      return sim_search_semi_patterns(opt.file_name, opt.cutoff, opt.metric, opt.input, output);
     else if (opt.method == "partition_pattern")
-      return sim_search_part_patterns(opt.file_name, opt.cutoff, opt.metric, opt.include_duplicates);
+      return sim_search_part_patterns(opt.file_name, opt.cutoff, opt.metric, opt.input, output);
     else
       throw std::runtime_error(
         "Invalid similarity join method use `pattern`, `semi_pattern` or `partition_pattern`");
@@ -6,92 +6,130 @@
 #include <string>
 #include <iostream>
 #include <mutex>
+#include <span>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
 #include "patterns_generators.hpp"
 #include "hash_containers.hpp"
 #include "trim_strings.hpp"
+#include "cost_model.hpp"
 
 
-template <TrimDirection trim_direction>
-void map_patterns_omp(
-  const std::vector<std::string>& strings,
+// Number of pattern map shards per thread of the team.
+constexpr size_t PATTERN_SHARDS_PER_THREAD = 4;
+
+// Pattern maps split by pattern hash: every pattern lives in exactly one
+// shard, so shards are merged and scanned independently of each other.
+struct ShardedPatterns {
+  str2ints_collection shards;
+  // Kept on request: the buckets of item i are item_buckets[item_begin[i]]
+  // up to item_buckets[item_begin[i + 1]], each as its shard in the high
+  // and its index among the shard's values in the low 32 bits.
+  std::vector<size_t> item_begin;
+  std::vector<uint64_t> item_buckets;
+
+  std::span<const uint64_t> buckets_of(size_t item) const {
+    return {item_buckets.data() + item_begin[item], item_begin[item + 1] - item_begin[item]};
+  }
+
+  const ints& bucket(uint64_t id) const {
+    return shards[id >> 32].values()[id & UINT32_MAX].second;
+  }
+
+  size_t shard_of(const std::string& pattern) const {
+    return hash_shard(pattern, shards.size());
+  }
+
+  const ints* find(const std::string& pattern) const {
+    const str2ints& shard = shards[shard_of(pattern)];
+    auto entry = shard.find(pattern);
+    return entry == shard.end() ? nullptr : &entry->second;
+  }
+};
+
+// Indexes the patterns of `items` by their positions in `items` using
+// taskloops of the current team. Every thread first sorts the patterns of its
+// items into per-shard buffers, then every shard is merged by one task, so no
+// pattern is ever looked up in more than one map. With `keep_item_buckets`
+// the buckets of every item are kept in `index` and the positions of every
+// bucket are sorted.
+inline void map_patterns_sharded(
+  const std::vector<GappedView>& items,
   int cutoff,
   char pattern_type,
-  str2int& str2idx,
-  const ints* strings_subset,
-  str2ints_collection& pat2str_collection,
-  const std::string& trim_part = "",
-  const char metric_type = 'L'
+  ShardedPatterns& index,
+  bool keep_item_buckets = false
 ) {
   PatternFuncType PatternFunc = getPatternFunc(cutoff, pattern_type);
-  int trim_size = trim_part.size();
-  for (int i = 0; i < omp_get_max_threads(); i++)
-    pat2str_collection.push_back(str2ints());
-  #pragma omp parallel 
-  {
-    int tid = omp_get_thread_num();
-    str2ints& pat2str_local = pat2str_collection[tid];
-    if (strings_subset == nullptr) {
-      #pragma omp for
-      for (std::string str: strings)
-        for (const auto& pattern: PatternFunc(str, nullptr))
-          pat2str_local[pattern].push_back(str2idx[str]);
-    } else {
-      if (trim_direction == TrimDirection::No) {
-        #pragma omp for
-        for (int str_idx: *strings_subset)
-          for (const auto& pattern: PatternFunc(strings[str_idx], nullptr))
-            pat2str_local[pattern].push_back(str_idx);
-      } else if (trim_direction == TrimDirection::Mid) {
-        MidTrimFunc midTrim = getMidTrimFunc(metric_type);
-        #pragma omp for
-        for (int str_idx: *strings_subset)
-          for (const auto& pattern: PatternFunc(midTrim(strings[str_idx], trim_part), nullptr))
-            pat2str_local[pattern].push_back(str_idx);
-      } else {
-        #pragma omp for
-        for (int str_idx: *strings_subset)
-          for (const auto& pattern: PatternFunc(trimString<trim_direction>(strings[str_idx], trim_size), nullptr))
-            pat2str_local[pattern].push_back(str_idx);
+  int P = omp_get_num_threads();
+  size_t n_shards = PATTERN_SHARDS_PER_THREAD * P;
+  index.shards.clear();
+  for (size_t shard = 0; shard < n_shards; shard++)
+    index.shards.push_back(str2ints());
+  // a pattern of the item at `pos`, the `ordinal`-th of the item's patterns
+  struct PatternOccurrence {
+    std::string pattern;
+    int pos;
+    int ordinal;
+  };
+  using shard_buffer = std::vector<PatternOccurrence>;
+  std::vector<std::vector<shard_buffer>> buffers(P, std::vector<shard_buffer>(n_shards));
+  std::vector<size_t>& item_begin = index.item_begin;
+  item_begin.assign(keep_item_buckets ? items.size() + 1 : 0, 0);
+
+  std::vector<int> order(items.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return items[a].size() > items[b].size();
+  });
+  std::vector<double> costs(order.size());
+  for (size_t i = 0; i < order.size(); i++)
+    costs[i] = pattern_cost(cutoff, pattern_type, items[order[i]].size());
+  std::vector<size_t> bounds = cost_partition(costs, COST_CHUNKS_PER_THREAD * P);
+
+  #pragma omp taskloop grainsize(1) shared(items, index, buffers, order, bounds, item_begin)
+  for (size_t chunk = 0; chunk < bounds.size() - 1; chunk++) {
+    std::vector<shard_buffer>& thread_buffers = buffers[omp_get_thread_num()];
+    for (size_t i = bounds[chunk]; i < bounds[chunk + 1]; i++) {
+      int ordinal = 0;
+      for (auto& pattern: PatternFunc(items[order[i]], nullptr)) {
+        size_t shard = index.shard_of(pattern);
+        thread_buffers[shard].push_back({std::move(pattern), order[i], ordinal++});
       }
+      if (keep_item_buckets)
+        item_begin[order[i] + 1] = ordinal;
     }
   }
-}
-
-template <TrimDirection trim_direction>
-void map_patterns(
-  const std::vector<std::string>& strings,
-  int cutoff,
-  char pattern_type,
-  str2int& str2idx,
-  const ints* strings_subset,
-  str2ints& pat2str,
-  const std::string& trim_part = "",
-  const char metric_type = 'L'
-) {
-  PatternFuncType PatternFunc = getPatternFunc(cutoff, pattern_type);
-  int trim_size = trim_part.size();
 
-  if (strings_subset == nullptr) {
-    for (std::string str: strings)
-      for (const auto& pattern: PatternFunc(str, nullptr))
-        pat2str[pattern].push_back(str2idx[str]);
+  std::vector<uint64_t>& item_buckets = index.item_buckets;
+  item_buckets.clear();
+  if (keep_item_buckets) {
+    std::partial_sum(item_begin.begin(), item_begin.end(), item_begin.begin());
+    item_buckets.resize(item_begin.back());
   }
-  else {
-    if (trim_direction == TrimDirection::No) {
-      for (int str_idx: *strings_subset)
-        for (const auto& pattern: PatternFunc(strings[str_idx], nullptr)) 
-          pat2str[pattern].push_back(str_idx);
-    }
-    else if (trim_direction == TrimDirection::Mid) {
-      MidTrimFunc midTrim = getMidTrimFunc(metric_type);
-      for (int str_idx: *strings_subset)
-        for (const auto& pattern: PatternFunc(midTrim(strings[str_idx], trim_part), nullptr)) 
-          pat2str[pattern].push_back(str_idx);
-    } else {
-      for (int str_idx: *strings_subset)
-        for (const auto& pattern: PatternFunc(trimString<trim_direction>(strings[str_idx], trim_size), nullptr)) 
-          pat2str[pattern].push_back(str_idx);
+
+  #pragma omp taskloop grainsize(1) shared(index, buffers, item_begin, item_buckets)
+  for (size_t shard = 0; shard < n_shards; shard++) {
+    str2ints& pat2pos = index.shards[shard];
+    size_t n_patterns = 0;
+    for (int tid = 0; tid < P; tid++)
+      n_patterns += buffers[tid][shard].size();
+    pat2pos.reserve(n_patterns);
+    for (int tid = 0; tid < P; tid++) {
+      for (auto& [pattern, pos, ordinal]: buffers[tid][shard]) {
+        auto entry = pat2pos.try_emplace(std::move(pattern)).first;
+        ints& positions = entry->second;
+        if (positions.empty() || positions.back() != pos)
+          positions.push_back(pos);
+        if (keep_item_buckets)
+          item_buckets[item_begin[pos] + ordinal] = (uint64_t(shard) << 32) | uint64_t(entry - pat2pos.begin());
+      }
+      shard_buffer().swap(buffers[tid][shard]);
     }
+    if (keep_item_buckets)
+      for (auto& entry: pat2pos)
+        std::sort(entry.second.begin(), entry.second.end());
   }
 }
 
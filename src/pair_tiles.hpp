@@ -0,0 +1,36 @@
+#ifndef PAIR_TILES_HPP
+#define PAIR_TILES_HPP
+
+#include <vector>
+#include <algorithm>
+
+// Rows (and columns) of a tile of the pair triangle: the trimmed strings of
+// a tile's rows and columns stay in cache while the tile is verified.
+constexpr size_t PAIR_TILE_SIZE = 256;
+
+// Pairs (i, j), i in [row_begin, row_end), j in [col_begin, col_end), i < j.
+struct PairTile {
+  size_t row_begin;
+  size_t row_end;
+  size_t col_begin;
+  size_t col_end;
+};
+
+// Splits the triangle i < j < size into square tiles, diagonal tiles included.
+inline std::vector<PairTile> triangle_tiles(size_t size, size_t tile_size = PAIR_TILE_SIZE) {
+  std::vector<PairTile> tiles;
+  for (size_t row = 0; row < size; row += tile_size)
+    for (size_t col = row; col < size; col += tile_size)
+      tiles.push_back({row, std::min(row + tile_size, size), col, std::min(col + tile_size, size)});
+  return tiles;
+}
+
+// Visits the pairs of a tile; `visit(i, j)` is called with i < j.
+template <typename Visit>
+inline void for_each_tile_pair(const PairTile& tile, Visit&& visit) {
+  for (size_t i = tile.row_begin; i < tile.row_end; i++)
+    for (size_t j = std::max(tile.col_begin, i + 1); j < tile.col_end; j++)
+      visit(i, j);
+}
+
+#endif // PAIR_TILES_HPP
@@ -0,0 +1,113 @@
+#ifndef PART_BOUNDS_HPP
+#define PART_BOUNDS_HPP
+
+#include <string>
+#include <algorithm>
+#include "hash_containers.hpp"
+
+// Substring [start, start + len) of a string used as a key of one part.
+struct PartBound {
+  int start;
+  int len;
+};
+using part_bounds = gch::small_vector<PartBound, 8>;
+
+// Generates the variants of part `part` for any number of parts k + 1.
+// A string of length n is the longer (or equal) side of every pair it probes:
+// for each shorter length m in [n - k, n] it takes the substrings that could
+// equal the part-th of the k + 1 even segments of a string of length m.
+// For Levenshtein distance the segment can only be shifted by at most `part`
+// edits before it and k - part edits after it (multi-match-aware selection);
+// for Hamming distance it stays in place. The first variants are prefixes and,
+// for Levenshtein distance, the last ones are suffixes, so Start/End trimming
+// still applies. Strings of length m own their segments among the m = n variants.
+inline part_bounds generate_part_bounds(
+  int str_len,
+  int n_parts,
+  int part,
+  char metric
+) {
+  int k = n_parts - 1;
+  part_bounds bounds;
+  for (int other_len = std::max(str_len - k, 1); other_len <= str_len; other_len++) {
+    int seg_len = other_len / n_parts;
+    int n_short = n_parts - other_len % n_parts;
+    int seg_start = part * seg_len + std::max(part - n_short, 0);
+    if (part >= n_short)
+      seg_len++;
+    int len_diff = str_len - other_len;
+    int first = seg_start, last = seg_start;
+    if (metric == 'L') {
+      first = std::max(seg_start - part, seg_start + len_diff - (k - part));
+      last = std::min(seg_start + part, seg_start + len_diff + (k - part));
+    }
+    first = std::max(first, 0);
+    last = std::min(last, str_len - seg_len);
+    for (int start = first; start <= last; start++) {
+      bool seen = false;
+      for (const PartBound& bound : bounds)
+        seen |= bound.start == start && bound.len == seg_len;
+      if (!seen)
+        bounds.push_back({start, seg_len});
+    }
+  }
+  return bounds;
+}
+
+// Variants of part `part` (0 is the start part, n_parts - 1 the end part) of a
+// string of length `str_len` when the string is split into `n_parts` parts.
+// The 2- and 3-part variants are tuned by hand and need fewer variants than
+// the generated ones, larger partitions are generated.
+inline part_bounds get_part_bounds(
+  int str_len,
+  int n_parts,
+  int part,
+  char metric
+) {
+  if (n_parts == 2) {
+    int half_len = str_len / 2;
+    bool odd = str_len % 2 == 1;
+    if (part == 0) {
+      if (!odd)
+        return {{0, half_len}};
+      return {{0, half_len}, {0, half_len + 1}};
+    }
+    if (!odd)
+      return {{half_len, str_len - half_len}};
+    if (metric == 'L')
+      return {{half_len, str_len - half_len}, {half_len + 1, str_len - half_len - 1}};
+    return {{half_len + 1, str_len - half_len - 1}};
+  }
+
+  if (n_parts == 3) {
+    int part_len = str_len / 3;
+    int residue = str_len % 3;
+    if (part == 0) {
+      if (residue == 0)
+        return {{0, part_len}};
+      return {{0, part_len}, {0, part_len + 1}};
+    }
+    if (part == 1) {
+      if (metric == 'L') {
+        if (residue == 0)
+          return {{part_len, part_len}, {part_len - 1, part_len}};
+        if (residue == 1)
+          return {{part_len, part_len}, {part_len + 1, part_len}, {part_len, part_len + 1}};
+        return {{part_len + 1, part_len}, {part_len + 1, part_len + 1}, {part_len, part_len + 1}};
+      }
+      if (residue == 0)
+        return {{part_len, part_len}};
+      if (residue == 1)
+        return {{part_len, part_len}, {part_len + 1, part_len}};
+      return {{part_len + 1, part_len}, {part_len + 1, part_len + 1}};
+    }
+    int end_start = part_len * 2 + residue;
+    if (metric == 'L' && residue != 0)
+      return {{end_start - 1, str_len - end_start + 1}, {end_start, str_len - end_start}};
+    return {{end_start, str_len - end_start}};
+  }
+
+  return generate_part_bounds(str_len, n_parts, part, metric);
+}
+
+#endif // PART_BOUNDS_HPP
@@ -1,172 +1,177 @@
 #include "patterns_generators.hpp"
 
 std::vector<std::string> Hamming1Patterns(
-    const std::string& str,
+    const GappedView& str,
     std::vector<std::string>* patterns
 ) {
+  std::vector<std::string> own_patterns;
   if (patterns == nullptr) {
-    patterns = new std::vector<std::string>();
-    patterns->reserve(str.length() + 1);
+    own_patterns.reserve(str.size() + 1);
+    patterns = &own_patterns;
   }
   std::string pattern;
-  for (int i = 0; i < static_cast<int>(str.length()); i++) {
-    pattern = str;
+  for (int i = 0; i < static_cast<int>(str.size()); i++) {
+    str.copy_to(pattern);
     pattern[i] = '_';
     patterns->push_back(pattern);
   }
-  pattern = str;
+  str.copy_to(pattern);
   pattern.push_back('_');
   patterns->push_back(pattern);
-  return *patterns;
+  return own_patterns;
 }
 
 std::vector<std::string> Hamming2Patterns(
-    const std::string& str,
+    const GappedView& str,
     std::vector<std::string>* patterns
 ) {
+  std::vector<std::string> own_patterns;
   if (patterns == nullptr) {
-    patterns = new std::vector<std::string>();
-    int n = str.length();
-    patterns->reserve(n * (n + 1) / 2 + n + 3);
+    int n = str.size();
+    own_patterns.reserve(n * (n + 1) / 2 + n + 3);
+    patterns = &own_patterns;
   }
   std::string pattern;
-  for (int i = 0; i < static_cast<int>(str.length()); i++) {
-    for (int j = i + 1; j < static_cast<int>(str.length()); j++) {
-      pattern = str;
+  for (int i = 0; i < static_cast<int>(str.size()); i++) {
+    for (int j = i + 1; j < static_cast<int>(str.size()); j++) {
+      str.copy_to(pattern);
       pattern[i] = pattern[j] = '_';
       patterns->push_back(pattern);
-      pattern = str;
+      str.copy_to(pattern);
       pattern[i] = '_';
       pattern.push_back('_');
       patterns->push_back(pattern);
     }
   }
-  pattern = str;
+  str.copy_to(pattern);
   pattern.push_back('_');
   pattern.push_back('_');
   patterns->push_back(pattern);
-  pattern = str;
-  pattern[static_cast<int>(str.length()) - 1] = '_';
+  str.copy_to(pattern);
+  pattern[static_cast<int>(str.size()) - 1] = '_';
   pattern.push_back('_');
   patterns->push_back(pattern);
   Hamming1Patterns(str, patterns);
-  return *patterns;
+  return own_patterns;
 }
 
 std::vector<std::string> Levi1Patterns(
-    const std::string& str,
+    const GappedView& str,
     std::vector<std::string>* patterns
 ) {
-   // Reserve space in the vector
+  std::vector<std::string> own_patterns;
   if (patterns == nullptr) {
-    patterns = new std::vector<std::string>();
-    patterns->reserve(str.length() * 2 + 1); 
+    own_patterns.reserve(str.size() * 2 + 1); 
+    patterns = &own_patterns;
   }
   std::string pattern, str1, str2;
-  for (int i = 0; i < static_cast<int>(str.length()); i++) {
-    pattern = str;
+  for (int i = 0; i < static_cast<int>(str.size()); i++) {
+    str.copy_to(pattern);
     pattern[i] = '_';
     // pattern.shrink_to_fit();
     patterns->push_back(pattern);
 
-    pattern = str;
+    str.copy_to(pattern);
     pattern.insert(i, 1, '_');
     // pattern.shrink_to_fit();
     patterns->push_back(pattern);
   }
-  pattern = str;
+  str.copy_to(pattern);
   pattern.push_back('_');
   patterns->push_back(pattern);
   // pattern.shrink_to_fit();
-  return *patterns;
+  return own_patterns;
 }
 
 std::vector<std::string> Levi2Patterns(
-    const std::string& str,
+    const GappedView& str,
     std::vector<std::string>* patterns
 ) {
+  std::vector<std::string> own_patterns;
   if (patterns == nullptr) {
-    patterns = new std::vector<std::string>();
-    int n = str.length();
-    patterns->reserve(2 * n * n + 3 * n + 2);
+    int n = str.size();
+    own_patterns.reserve(2 * n * n + 3 * n + 2);
+    patterns = &own_patterns;
   }
   std::string pattern;
-  for (int i = 0; i < static_cast<int>(str.length()); i++) {
+  for (int i = 0; i < static_cast<int>(str.size()); i++) {
     for (int j = 0; j < i; j++) {
-      pattern = str;
+      str.copy_to(pattern);
       pattern.insert(j, 1, '_');
       pattern[i + 1] = '_';
       patterns->push_back(pattern); // k + 1
     }
     for (int j = i; j < static_cast<int>(str.size()); j++) {
       if (j > i) {
-        pattern = str;
+        str.copy_to(pattern);
         pattern[i] = '_';
         pattern[j] = '_';
         patterns->push_back(pattern); // k
       }
-      pattern = str;
+      str.copy_to(pattern);
       pattern[i] = '_';
       pattern.insert(j + 1, 1, '_');
       patterns->push_back(pattern); // k + 1
-      pattern = str;
+      str.copy_to(pattern);
       pattern.insert(i, 1, '_');
       pattern.insert(j + 1, 1, '_');
       patterns->push_back(pattern); // k + 2
     }
-    pattern = str;
+    str.copy_to(pattern);
     pattern.insert(i, 1, '_');
     pattern.push_back('_');
     patterns->push_back(pattern); // k + 2
   }
-  pattern = str;
+  str.copy_to(pattern);
   pattern.push_back('_');
   pattern.push_back('_');
   patterns->push_back(pattern); // k + 2
   Levi1Patterns(str, patterns);
-  return *patterns;
+  return own_patterns;
 }
 
 std::vector<std::string> semi1Patterns(
-    const std::string& str,
+    const GappedView& str,
     std::vector<std::string>* patterns
 ) {
+  std::vector<std::string> own_patterns;
   if (patterns == nullptr) {
-    patterns = new std::vector<std::string>();
-    patterns->reserve(str.length() + 1);
+    own_patterns.reserve(str.size() + 1);
+    patterns = &own_patterns;
   }
   std::string pattern;
-  for (int i = 0; i < static_cast<int>(str.length()); i++) {
-    pattern = str;
+  for (int i = 0; i < static_cast<int>(str.size()); i++) {
+    str.copy_to(pattern);
     pattern.erase(i, 1);
     patterns->push_back(pattern);
   }
-  patterns->push_back(str);
-  return *patterns;
+  patterns->push_back(str.str());
+  return own_patterns;
 }
 
 std::vector<std::string> semi2Patterns(
-    const std::string& str,
+    const GappedView& str,
     std::vector<std::string>* patterns
 ) {
+  std::vector<std::string> own_patterns;
   if (patterns == nullptr) {
-    patterns = new std::vector<std::string>();
-    patterns->reserve((str.length()) * (str.length() + 3) / 2);
+    own_patterns.reserve((str.size()) * (str.size() + 3) / 2);
+    patterns = &own_patterns;
   }
   std::string pattern;
   for (int i = 0; i < static_cast<int>(str.size()); ++i) {
-    pattern = str;
+    str.copy_to(pattern);
     pattern.erase(i, 1);
     patterns->push_back(pattern);
     for (int j = i + 1; j < static_cast<int>(str.size()); ++j) {
-      pattern = str;
+      str.copy_to(pattern);
       pattern.erase(i, 1);
       pattern.erase(j - 1, 1);
       patterns->push_back(pattern);
     }
   }
-  patterns->push_back(str);
-  return *patterns;
+  patterns->push_back(str.str());
+  return own_patterns;
 }
 
 PatternFuncType getPatternFunc(int cutoff, char pattern_type) {
@@ -4,38 +4,41 @@
 #include <vector>
 #include <string>
 #include <stdexcept>
+#include "gapped_view.hpp"
 
 
-using PatternFuncType = std::vector<std::string>(*)(const std::string&, std::vector<std::string>*);
+// Pattern generators append the patterns of `str` to `*patterns` when it is
+// given, otherwise they return them in a new vector.
+using PatternFuncType = std::vector<std::string>(*)(const GappedView&, std::vector<std::string>*);
 PatternFuncType getPatternFunc(int cutoff, char pattern_type);
 
 std::vector<std::string> Hamming1Patterns(
-    const std::string& str,
+    const GappedView& str,
     std::vector<std::string>* patterns = nullptr
 );
 
 std::vector<std::string> Hamming2Patterns(
-    const std::string& str,
+    const GappedView& str,
     std::vector<std::string>* patterns = nullptr
 );
 
 std::vector<std::string> Levi1Patterns(
-    const std::string& str,
+    const GappedView& str,
     std::vector<std::string>* patterns = nullptr
 );
 
 std::vector<std::string> Levi2Patterns(
-    const std::string& str,
+    const GappedView& str,
     std::vector<std::string>* patterns = nullptr
 );
 
 std::vector<std::string> semi1Patterns(
-    const std::string& str,
+    const GappedView& str,
     std::vector<std::string>* patterns
 );
 
 std::vector<std::string> semi2Patterns(
-    const std::string& str,
+    const GappedView& str,
     std::vector<std::string>* patterns
 );
 
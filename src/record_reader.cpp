@@ -0,0 +1,201 @@
+#include "record_reader.hpp"
+#include <zlib.h>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+InputFormat parseInputFormat(const std::string& name) {
+  if (name == "lines")
+    return InputFormat::Lines;
+  if (name == "tsv")
+    return InputFormat::Tsv;
+  if (name == "fasta")
+    return InputFormat::Fasta;
+  throw std::invalid_argument("Invalid input format, use `lines`, `tsv` or `fasta`");
+}
+
+ChunkReader::ChunkReader(const std::string& file_name) {
+  // gzread passes files without a gzip header through unchanged
+  file = gzopen(file_name.c_str(), "rb");
+  if (file == nullptr)
+    throw std::runtime_error("File does not exist");
+  gzbuffer(file, INPUT_CHUNK_SIZE);
+  reader = std::thread(&ChunkReader::read_loop, this);
+}
+
+ChunkReader::~ChunkReader() {
+  // a reader thread waiting for room wakes up and stops
+  queue.close();
+  if (reader.joinable())
+    reader.join();
+}
+
+bool ChunkReader::next(std::string& chunk) {
+  if (queue.pop(chunk))
+    return true;
+  if (error)
+    std::rethrow_exception(error);
+  return false;
+}
+
+void ChunkReader::read_loop() {
+  try {
+    while (true) {
+      std::string chunk(INPUT_CHUNK_SIZE, '\0');
+      int n_read = gzread(file, chunk.data(), chunk.size());
+      if (n_read < 0) {
+        int errnum;
+        throw std::runtime_error(std::string("Cannot read the input file: ") + gzerror(file, &errnum));
+      }
+      if (n_read == 0)
+        break;
+      chunk.resize(n_read);
+      if (!queue.push(std::move(chunk)))
+        break;
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  gzclose(file);
+  queue.close();
+}
+
+bool isGzipFile(const std::string& file_name) {
+  std::ifstream in_file(file_name, std::ios::binary);
+  char magic[2] = {0, 0};
+  in_file.read(magic, 2);
+  return in_file && magic[0] == '\x1f' && magic[1] == '\x8b';
+}
+
+// Collects the sequences of one input format, line by line.
+class RecordParser {
+public:
+  RecordParser(
+    const std::string& file_name,
+    const InputOptions& input,
+    std::string& data,
+    std::vector<SequenceView>& sequences
+  ) : file_name(file_name), input(input), data(data), sequences(sequences) {}
+
+  void line(std::string_view line) {
+    line_number++;
+    if (input.format == InputFormat::Lines) {
+      if (line.empty())
+        throw std::runtime_error("Empty line spotted in the input file\n");
+      add(line);
+      return;
+    }
+    if (!line.empty() && line.back() == '\r')
+      line.remove_suffix(1);
+    if (line.empty())
+      return;
+    if (input.format == InputFormat::Tsv)
+      tsv_line(line);
+    else
+      fasta_line(line);
+  }
+
+  void finish() {
+    if (input.format == InputFormat::Tsv && column == SIZE_MAX)
+      throw std::runtime_error("No header row in " + file_name);
+    if (input.format == InputFormat::Fasta)
+      finish_record();
+  }
+
+private:
+  const std::string& file_name;
+  const InputOptions& input;
+  std::string& data;
+  std::vector<SequenceView>& sequences;
+  // 1-based number of the current line in the file
+  size_t line_number = 0;
+  // tsv: index of the requested column, SIZE_MAX before the header
+  size_t column = SIZE_MAX;
+  // fasta: start of the current record in `data`, SIZE_MAX before the first
+  size_t record = SIZE_MAX;
+  // fasta: header line of the current record
+  std::string header;
+
+  void add(std::string_view sequence) {
+    sequences.push_back({data.size(), static_cast<uint32_t>(sequence.size())});
+    data.append(sequence);
+  }
+
+  // Field `index` of a tab-separated line, or false if the line has fewer.
+  static bool field(std::string_view line, size_t index, std::string_view& value) {
+    size_t begin = 0;
+    for (size_t i = 0; i < index; i++) {
+      begin = line.find('\t', begin);
+      if (begin == std::string_view::npos)
+        return false;
+      begin++;
+    }
+    value = line.substr(begin, line.find('\t', begin) - begin);
+    return true;
+  }
+
+  void tsv_line(std::string_view line) {
+    std::string_view value;
+    if (column == SIZE_MAX) {
+      for (column = 0; field(line, column, value); column++)
+        if (value == input.column)
+          return;
+      throw std::invalid_argument("Column " + input.column + " not found in " + file_name);
+    }
+    if (!field(line, column, value))
+      throw std::runtime_error("Row without column " + input.column + " in " + file_name);
+    if (value.empty())
+      throw std::runtime_error("Empty " + input.column + " in line " + std::to_string(line_number) + " of " + file_name);
+    add(value);
+  }
+
+  void finish_record() {
+    if (record == SIZE_MAX)
+      return;
+    if (data.size() == record)
+      throw std::runtime_error("Empty sequence in FASTA record " + header + " of " + file_name);
+    sequences.push_back({record, static_cast<uint32_t>(data.size() - record)});
+  }
+
+  void fasta_line(std::string_view line) {
+    if (line.front() == '>') {
+      finish_record();
+      record = data.size();
+      header = line;
+    } else if (line.front() != ';') {
+      if (record == SIZE_MAX)
+        throw std::runtime_error("Sequence before the first FASTA header in " + file_name);
+      data.append(line);
+    }
+  }
+};
+
+void readRecords(
+  const std::string& file_name,
+  const InputOptions& input,
+  std::string& data,
+  std::vector<SequenceView>& sequences
+) {
+  RecordParser parser(file_name, input, data, sequences);
+  ChunkReader reader(file_name);
+  std::string chunk;
+  // start of a line cut at the end of the previous chunk
+  std::string pending;
+  while (reader.next(chunk)) {
+    size_t begin = 0;
+    for (size_t end = chunk.find('\n'); end != std::string::npos; begin = end + 1, end = chunk.find('\n', begin)) {
+      std::string_view line(chunk.data() + begin, end - begin);
+      if (pending.empty()) {
+        parser.line(line);
+        continue;
+      }
+      pending.append(line);
+      parser.line(pending);
+      pending.clear();
+    }
+    pending.append(chunk, begin);
+  }
+  if (!pending.empty())
+    parser.line(pending);
+  parser.finish();
+}
@@ -0,0 +1,79 @@
+#ifndef RECORD_READER_HPP
+#define RECORD_READER_HPP
+
+#include <thread>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <exception>
+#include "bounded_queue.hpp"
+#include "input_parser.hpp"
+
+struct gzFile_s;
+
+// Layout of the input file. Any of them may be gzip-compressed.
+enum class InputFormat {
+  Lines,  // one sequence per line
+  Tsv,    // tab-separated table with a header row, e.g. AIRR rearrangements
+  Fasta   // ">" header lines, each followed by the lines of one sequence
+};
+
+// Where the sequences of the input are taken from.
+struct InputOptions {
+  InputFormat format = InputFormat::Lines;
+  // header of the column holding the sequences in the tsv format
+  std::string column = "junction_aa";
+};
+
+// Parses `lines`, `tsv` or `fasta`.
+InputFormat parseInputFormat(const std::string& name);
+
+// Decompressed bytes per chunk handed from the reader thread to the parser.
+constexpr size_t INPUT_CHUNK_SIZE = 1 << 20;
+
+// Chunks the queue may hold before the reader thread waits for the parser.
+constexpr size_t INPUT_QUEUE_CHUNKS = 16;
+
+// Reads a plain or gzip-compressed file on a dedicated thread: the thread
+// reads and inflates the file chunk by chunk into a bounded queue while the
+// caller parses the chunks read so far.
+class ChunkReader {
+public:
+  explicit ChunkReader(const std::string& file_name);
+  ~ChunkReader();
+  ChunkReader(const ChunkReader&) = delete;
+  ChunkReader& operator=(const ChunkReader&) = delete;
+
+  // Moves the next chunk into `chunk`; waits for the reader thread. Returns
+  // false at the end of the file and rethrows the reader thread's errors.
+  bool next(std::string& chunk);
+
+private:
+  void read_loop();
+
+  gzFile_s* file;
+  // closed by the reader thread after its last chunk, or by the destructor
+  // to stop the reader thread early
+  BoundedQueue<std::string> queue{INPUT_QUEUE_CHUNKS};
+  // set by the reader thread before it closes the queue
+  std::exception_ptr error;
+  std::thread reader;
+};
+
+// Whether the file starts with the gzip magic bytes.
+bool isGzipFile(const std::string& file_name);
+
+// Streams the sequences of `file_name` in `input.format` into `data`, one
+// after the other, with their positions in `sequences`: the lines of the
+// lines format, the values of `input.column` of the tsv format or the records
+// of the fasta format with their lines joined. Empty lines are rejected in
+// the lines format, as by parseLines, and skipped in the other formats; an
+// empty tsv value or fasta record is rejected with its line or header.
+void readRecords(
+  const std::string& file_name,
+  const InputOptions& input,
+  std::string& data,
+  std::vector<SequenceView>& sequences
+);
+
+#endif // RECORD_READER_HPP
@@ -0,0 +1,99 @@
+#include "sequence_table.hpp"
+#include "hash_containers.hpp"
+#include <omp.h>
+
+SequenceTable buildSequenceTable(std::string_view data, const std::vector<SequenceView>& lines) {
+  size_t n_lines = lines.size();
+  size_t n_blocks = omp_get_max_threads();
+  size_t n_shards = DEDUP_SHARDS_PER_THREAD * n_blocks;
+  auto line = [&](size_t i) { return data.substr(lines[i].offset, lines[i].length); };
+  auto block_begin = [&](size_t block) { return n_lines * block / n_blocks; };
+
+  // shard of every line, and the lines of every block per shard
+  std::vector<uint32_t> shard_of(n_lines);
+  std::vector<size_t> shard_counts(n_blocks * n_shards, 0);
+  #pragma omp parallel for schedule(static, 1)
+  for (size_t block = 0; block < n_blocks; block++)
+    for (size_t i = block_begin(block); i < block_begin(block + 1); i++) {
+      shard_of[i] = hash_shard(line(i), n_shards);
+      shard_counts[block * n_shards + shard_of[i]]++;
+    }
+
+  // counting sort by shard, lines of a shard stay ascending: block-major
+  // positions within each shard
+  std::vector<size_t> shard_offsets(n_shards + 1, 0);
+  std::vector<size_t> next(n_blocks * n_shards);
+  for (size_t shard = 0, pos = 0; shard < n_shards; shard++) {
+    shard_offsets[shard] = pos;
+    for (size_t block = 0; block < n_blocks; block++) {
+      next[block * n_shards + shard] = pos;
+      pos += shard_counts[block * n_shards + shard];
+    }
+  }
+  shard_offsets[n_shards] = n_lines;
+  std::vector<int> sorted_lines(n_lines);
+  #pragma omp parallel for schedule(static, 1)
+  for (size_t block = 0; block < n_blocks; block++)
+    for (size_t i = block_begin(block); i < block_begin(block + 1); i++)
+      sorted_lines[next[block * n_shards + shard_of[i]]++] = i;
+
+  // first line of the sequence of every line
+  std::vector<int> first_line(n_lines);
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t shard = 0; shard < n_shards; shard++) {
+    ankerl::unordered_dense::map<std::string_view, int> first;
+    first.reserve(shard_offsets[shard + 1] - shard_offsets[shard]);
+    for (size_t pos = shard_offsets[shard]; pos < shard_offsets[shard + 1]; pos++) {
+      int i = sorted_lines[pos];
+      first_line[i] = first.try_emplace(line(i), i).first->second;
+    }
+  }
+
+  // ids in the order of first lines: first lines per block, then their ids
+  SequenceTable table;
+  table.line_ids.resize(n_lines);
+  std::vector<size_t> block_ids(n_blocks + 1, 0);
+  #pragma omp parallel for schedule(static, 1)
+  for (size_t block = 0; block < n_blocks; block++)
+    for (size_t i = block_begin(block); i < block_begin(block + 1); i++)
+      block_ids[block + 1] += first_line[i] == static_cast<int>(i);
+  for (size_t block = 0; block < n_blocks; block++)
+    block_ids[block + 1] += block_ids[block];
+  size_t n_unique = block_ids[n_blocks];
+  #pragma omp parallel for schedule(static, 1)
+  for (size_t block = 0; block < n_blocks; block++) {
+    int id = block_ids[block];
+    for (size_t i = block_begin(block); i < block_begin(block + 1); i++)
+      if (first_line[i] == static_cast<int>(i))
+        table.line_ids[i] = id++;
+  }
+  #pragma omp parallel for
+  for (size_t i = 0; i < n_lines; i++)
+    if (first_line[i] != static_cast<int>(i))
+      table.line_ids[i] = table.line_ids[first_line[i]];
+
+  // groups: all lines of an id are in one shard, so every shard counts and
+  // fills its own groups
+  table.group_offsets.assign(n_unique + 1, 0);
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t shard = 0; shard < n_shards; shard++)
+    for (size_t pos = shard_offsets[shard]; pos < shard_offsets[shard + 1]; pos++)
+      table.group_offsets[table.line_ids[sorted_lines[pos]] + 1]++;
+  for (size_t id = 0; id < n_unique; id++)
+    table.group_offsets[id + 1] += table.group_offsets[id];
+  table.group_lines.resize(n_lines);
+  std::vector<int> group_next(table.group_offsets.begin(), table.group_offsets.end() - 1);
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t shard = 0; shard < n_shards; shard++)
+    for (size_t pos = shard_offsets[shard]; pos < shard_offsets[shard + 1]; pos++) {
+      int i = sorted_lines[pos];
+      table.group_lines[group_next[table.line_ids[i]]++] = i;
+    }
+
+  table.strings.resize(n_unique);
+  #pragma omp parallel for
+  for (size_t i = 0; i < n_lines; i++)
+    if (first_line[i] == static_cast<int>(i))
+      table.strings[table.line_ids[i]].assign(line(i));
+  return table;
+}
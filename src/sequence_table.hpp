@@ -0,0 +1,44 @@
+#ifndef SEQUENCE_TABLE_HPP
+#define SEQUENCE_TABLE_HPP
+
+#include <span>
+#include <vector>
+#include <string>
+#include <string_view>
+#include "input_parser.hpp"
+
+// Distinct sequences of the input and the input lines of each. The joins
+// run on `strings` only; ids are indices of `strings`, and the lines of an
+// id are only needed to expand the output with duplicates.
+struct SequenceTable {
+  // unique sequences in the order of their first input line
+  std::vector<std::string> strings;
+  // unique id of every input line
+  std::vector<int> line_ids;
+  // input lines of id u, ascending: group_lines[group_offsets[u]] up to
+  // group_lines[group_offsets[u + 1]]
+  std::vector<int> group_offsets;
+  std::vector<int> group_lines;
+
+  size_t n_lines() const { return line_ids.size(); }
+  size_t group_size(int id) const { return group_offsets[id + 1] - group_offsets[id]; }
+  std::span<const int> group(int id) const {
+    return {group_lines.data() + group_offsets[id], group_size(id)};
+  }
+  // views of `strings`, the input of the joins that trim strings to views
+  std::vector<std::string_view> views() const {
+    return std::vector<std::string_view>(strings.begin(), strings.end());
+  }
+};
+
+// Hash shards per thread of the deduplication; a shard is deduplicated by
+// one task on its own, so more shards balance skewed inputs better.
+constexpr size_t DEDUP_SHARDS_PER_THREAD = 4;
+
+// Deduplicates the `lines` of `data` in parallel: lines are hashed and
+// counting-sorted into shards by hash, every shard finds the first line of
+// each of its sequences with its own hash map, ids are numbered by first
+// line and only the unique sequences are copied out of `data`.
+SequenceTable buildSequenceTable(std::string_view data, const std::vector<SequenceView>& lines);
+
+#endif // SEQUENCE_TABLE_HPP
@@ -1,159 +1,85 @@
 #include "sim_search_part_patterns.hpp"
-#include <chrono>
-#include <iostream>
 
-void sim_search_2parts(
-  std::vector<std::string> &strings,
+// Buckets of every part of the (cutoff + 1)-part scheme.
+static std::vector<str2ints> distribute_parts(
+  const std::vector<std::string_view>& strings,
+  int n_parts,
+  char metric
+) {
+  std::vector<str2ints> part2idxs;
+  part2idxs.reserve(n_parts);
+  for (int part = 0; part < n_parts; part++) {
+    part2idxs.push_back(str2ints());
+    distribute_part(strings, n_parts, part, metric, part2idxs.back());
+  }
+  return part2idxs;
+}
+
+// Strings sharing a part are verified with the part trimmed from the start,
+// the end or not at all.
+static void collect_part_tasks(
+  const std::vector<std::string_view>& strings,
   char metric,
-  str2int& str2idx,
-  int_pair_set& out,
-  bool include_eye = true,
-  int cutoff = 1
+  const std::vector<str2ints>& part2idxs,
+  std::vector<BucketTask>& tasks
 ) {
-  str2ints start2idxs, end2idxs;
-  start2idxs.reserve(strings.size());
-  end2idxs.reserve(strings.size());
-  if (metric == 'L')
-    for (size_t i = 0; i < strings.size(); i++) {
-      std::string str = strings[i];
-      size_t half_len = str.size() / 2;
-      start2idxs[str.substr(0, half_len)].push_back(i);
-      end2idxs[str.substr(half_len)].push_back(i);
-      if (str.size() % 2 == 1) {
-        start2idxs[str.substr(0, half_len + 1)].push_back(i);
-        end2idxs[str.substr(half_len + 1)].push_back(i);
-      }
-    }
-  else
-    for (size_t i = 0; i < strings.size(); i++) {
-      std::string str = strings[i];
-      size_t half_len = str.size() / 2;
-      if (str.size() % 2 == 0) {
-        start2idxs[str.substr(0, half_len)].push_back(i);
-        end2idxs[str.substr(half_len)].push_back(i);
-      }
-      else {
-        start2idxs[str.substr(0, half_len)].push_back(i);
-        start2idxs[str.substr(0, half_len + 1)].push_back(i);
-        end2idxs[str.substr(half_len + 1)].push_back(i);
-      }
-    }
-  
-  check_part<TrimDirection::Start>(strings, cutoff, metric, str2idx, start2idxs, out);
+  int n_parts = part2idxs.size();
+  check_part<TrimDirection::Start>(strings, part2idxs[0], n_parts, 0, tasks);
+  for (int part = 1; part < n_parts - 1; part++)
+    check_part<TrimDirection::No>(strings, part2idxs[part], n_parts, part, tasks);
   if (metric == 'L')
-    check_part<TrimDirection::End>(strings, cutoff, metric, str2idx, end2idxs, out);
+    check_part<TrimDirection::End>(strings, part2idxs[n_parts - 1], n_parts, n_parts - 1, tasks);
   else
-    check_part<TrimDirection::No>(strings, cutoff, metric, str2idx, end2idxs, out);
-  
-  if (include_eye)
-    for (size_t i = 0; i < strings.size(); i++)
-      out.insert({i, i});
+    check_part<TrimDirection::No>(strings, part2idxs[n_parts - 1], n_parts, n_parts - 1, tasks);
 }
 
-void sim_search_3parts(
-  std::vector<std::string> &strings,
+void join_parts(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
   char metric,
-  str2int& str2idx,
-  int_pair_set& out,
+  EdgeBuffer& out
+) {
+  std::vector<str2ints> part2idxs = distribute_parts(strings, cutoff + 1, metric);
+  std::vector<BucketTask> tasks;
+  collect_part_tasks(strings, metric, part2idxs, tasks);
+  check_buckets(strings, cutoff, metric, tasks, out);
+}
+
+// Splits every string into cutoff + 1 parts: by the pigeonhole principle two
+// strings within the cutoff share at least one part.
+void sim_search_parts(
+  const std::vector<std::string_view>& strings,
+  char metric,
+  EdgeBuffer& out,
   bool include_eye = true,
   int cutoff = 1
 ) {
-  str2ints start2idxs, mid2idxs, end2idxs;
-  start2idxs.reserve(strings.size());
-  mid2idxs.reserve(strings.size());
-  end2idxs.reserve(strings.size());
-  auto start = std::chrono::high_resolution_clock::now();
-  if (metric == 'L')
-    for (size_t i = 0; i < strings.size(); i++) {
-      std::string str = strings[i];
-      size_t part_len = str.size() / 3;
-      size_t residue = str.size() % 3;
-      if (residue == 0) {
-        start2idxs[str.substr(0, part_len)].push_back(i);
-        mid2idxs[str.substr(part_len, part_len)].push_back(i);
-        mid2idxs[str.substr(part_len - 1, part_len)].push_back(i);
-        end2idxs[str.substr(part_len * 2)].push_back(i);
-      } else if (residue == 1) {
-        start2idxs[str.substr(0, part_len)].push_back(i);
-        start2idxs[str.substr(0, part_len + 1)].push_back(i);
-        mid2idxs[str.substr(part_len, part_len)].push_back(i);
-        mid2idxs[str.substr(part_len + 1, part_len)].push_back(i);
-        mid2idxs[str.substr(part_len, part_len + 1)].push_back(i);
-        end2idxs[str.substr(part_len * 2)].push_back(i);
-        end2idxs[str.substr(part_len * 2 + 1)].push_back(i);
-      } else if (residue == 2) {
-        start2idxs[str.substr(0, part_len)].push_back(i);
-        start2idxs[str.substr(0, part_len + 1)].push_back(i);
-        mid2idxs[str.substr(part_len + 1, part_len)].push_back(i);
-        mid2idxs[str.substr(part_len + 1, part_len + 1)].push_back(i);
-        mid2idxs[str.substr(part_len, part_len + 1)].push_back(i);
-        end2idxs[str.substr(part_len * 2 + 1)].push_back(i);
-        end2idxs[str.substr(part_len * 2 + 2)].push_back(i);
-      }
-    }
-  else
-    for (size_t i = 0; i < strings.size(); i++) {
-      std::string str = strings[i];
-      size_t part_len = str.size() / 3;
-      size_t residue = str.size() % 3;
-      if (residue == 0) {
-        start2idxs[str.substr(0, part_len)].push_back(i);
-        mid2idxs[str.substr(part_len, part_len)].push_back(i);
-        end2idxs[str.substr(part_len * 2)].push_back(i);
-      } else if (residue == 1) {
-        start2idxs[str.substr(0, part_len)].push_back(i);
-        start2idxs[str.substr(0, part_len + 1)].push_back(i);
-        mid2idxs[str.substr(part_len, part_len)].push_back(i);
-        mid2idxs[str.substr(part_len + 1, part_len)].push_back(i);
-        end2idxs[str.substr(part_len * 2 + 1)].push_back(i);
-      } else if (residue == 2) {
-        start2idxs[str.substr(0, part_len)].push_back(i);
-        start2idxs[str.substr(0, part_len + 1)].push_back(i);
-        mid2idxs[str.substr(part_len + 1, part_len)].push_back(i);
-        mid2idxs[str.substr(part_len + 1, part_len + 1)].push_back(i);
-        end2idxs[str.substr(part_len * 2 + 2)].push_back(i);
-      }
-    }
-  auto end = std::chrono::high_resolution_clock::now();
-  std::chrono::duration<double> elapsed = end - start;
-  std::cout << "parts distribution: " << elapsed.count() << " s\n";
-
-  start = std::chrono::high_resolution_clock::now();
-  check_part<TrimDirection::Start>(strings, cutoff, metric, str2idx, start2idxs, out);
-  check_part<TrimDirection::No>(strings, cutoff, metric, str2idx, mid2idxs, out);
-  if (metric == 'L')
-    check_part<TrimDirection::End>(strings, cutoff, metric, str2idx, end2idxs, out);
-  else
-    check_part<TrimDirection::No>(strings, cutoff, metric, str2idx, end2idxs, out);
+  join_parts(strings, cutoff, metric, out);
   if (include_eye)
     #pragma omp parallel for
     for (size_t i = 0; i < strings.size(); i++)
       out.insert({i, i});
-  end = std::chrono::high_resolution_clock::now();
-  elapsed = end - start;
-  std::cout << "check_part total: " << elapsed.count() << " s\n";
 }
 
 int sim_search_part_patterns(
   std::string file_name,
   int cutoff,
   char metric,
-  bool include_duplicates
+  const InputOptions& input,
+  const OutputOptions& output
 ) {
-  std::vector<std::string> strings;
-  str2int str2idx;
-  str2ints str2idxs;
-  readFile(file_name, strings, str2idx, include_duplicates, str2idxs);
+  SequenceTable table;
+  readFile(file_name, input, table);
+  std::vector<std::string_view> strings = table.views();
 
-  int_pair_set out;
-  if (cutoff == 1)
-    sim_search_2parts(strings, metric, str2idx, out, true, cutoff);
-  else if (cutoff == 2)
-    sim_search_3parts(strings, metric, str2idx, out, true, cutoff);
-  else
+  std::string out_file_name = file_name + "_pp_" + std::to_string(cutoff) + "_" + metric;
+  if (cutoff < 1)
     throw std::invalid_argument("Cutoff=" + std::to_string(cutoff)  + " not implemented for this method.");
+  std::unique_ptr<EdgeStream> stream = openEdgeStream(out_file_name, table, output);
+  std::unique_ptr<EdgeSummary> summary = openEdgeSummary(table, output);
+  EdgeBuffer out(stream.get(), summary.get());
+  sim_search_parts(strings, metric, out, true, cutoff);
 
-  std::string out_file_name = file_name + "_pp_" + std::to_string(cutoff) + "_" + metric;
-  writeFile(out_file_name, out, strings, str2idxs, include_duplicates);
+  writeEdges(out_file_name, out, stream.get(), summary.get(), table, output);
   return 0;
 }
\ No newline at end of file
@@ -10,128 +10,348 @@
 #include "file_io.hpp"
 #include "bounded_edit_distance.hpp"
 #include "trim_strings.hpp"
+#include "cost_model.hpp"
+#include "part_bounds.hpp"
+#include "sorted_bucket.hpp"
 #include "omp.h"
 #include <iostream>
-#include <chrono>
+#include <algorithm>
 
 extern size_t SIM_SEARCH_THRESHOLD;
 extern size_t OMP_SIM_SEARCH_THRESHOLD;
+extern size_t SPLIT_SIM_SEARCH_THRESHOLD;
 
+// Puts every string into the buckets of all variants of part `part`, at most
+// once per bucket.
+inline void distribute_part(
+  const std::vector<std::string_view>& strings,
+  int n_parts,
+  int part,
+  char metric,
+  str2ints& part2idxs
+) {
+  part2idxs.reserve(strings.size());
+  for (size_t i = 0; i < strings.size(); i++)
+    for (const PartBound& bound : get_part_bounds(strings[i].size(), n_parts, part, metric)) {
+      ints& idxs = part2idxs[std::string(strings[i].substr(bound.start, bound.len))];
+      if (idxs.empty() || idxs.back() != static_cast<int>(i))
+        idxs.push_back(i);
+    }
+}
+
+// Canonical-part rule: a pair found in the bucket `key` of part `part` is
+// accepted only if this is the first bucket both strings share, i.e. they
+// share no bucket of an earlier part and no shorter (or lexicographically
+// smaller) key of the same part. Any shared bucket decides the distance
+// exactly, so every pair is verified and emitted once.
+struct FirstSharedPart {
+  const std::vector<std::string_view>& strings;
+  int n_parts;
+  int part;
+  char metric;
+  const std::string& key;
+
+  // Whether the rule costs less than verifying a pair of strings of length
+  // `str_len`, so it runs before the distance. It compares every variant of
+  // the parts up to `part` with every other: a few for the hand-tabled 2-
+  // and 3-part bounds, dozens for generated ones.
+  bool runs_first(int cutoff, size_t str_len) const {
+    double variant_pairs = 0;
+    for (int prev_part = 0; prev_part <= part; prev_part++) {
+      double n_bounds = get_part_bounds(str_len, n_parts, prev_part, metric).size();
+      variant_pairs += n_bounds * n_bounds;
+    }
+    return key_compare_cost(variant_pairs) < verify_cost(metric, cutoff, str_len);
+  }
+
+  bool operator()(int str_idx1, int str_idx2) const {
+    std::string_view str1 = strings[str_idx1];
+    std::string_view str2 = strings[str_idx2];
+    for (int prev_part = 0; prev_part <= part; prev_part++) {
+      part_bounds bounds1 = get_part_bounds(str1.size(), n_parts, prev_part, metric);
+      part_bounds bounds2 = get_part_bounds(str2.size(), n_parts, prev_part, metric);
+      for (const PartBound& bound1 : bounds1) {
+        if (prev_part == part && (bound1.len > static_cast<int>(key.size()) ||
+            (bound1.len == static_cast<int>(key.size()) && str1.compare(bound1.start, bound1.len, key) >= 0)))
+          continue;
+        for (const PartBound& bound2 : bounds2)
+          if (bound1.len == bound2.len && str1.compare(bound1.start, bound1.len, str2, bound2.start, bound2.len) == 0)
+            return false;
+      }
+    }
+    return true;
+  }
+};
+
+// Trims every member of a bucket by the bucket key and orders the members
+// by length and character signature for windowed verification.
 template <TrimDirection trim_direction>
-inline void check_part(
-  std::vector<std::string> &strings,
+inline SortedBucket sort_bucket(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
+  char metric,
+  const std::pair<std::string, ints>& entry
+) {
+  int part_len = entry.first.size();
+  std::vector<BucketMember> members;
+  members.reserve(entry.second.size());
+  MidTrimFunc midTrim = getMidTrimFunc(metric);
+  for (int str_idx: entry.second) {
+    GappedView trimmed = trim_direction == TrimDirection::Mid
+      ? midTrim(strings[str_idx], entry.first)
+      : GappedView(trimString<trim_direction>(strings[str_idx], part_len));
+    members.push_back({str_idx, static_cast<int>(trimmed.size()), char_signature(trimmed), trimmed});
+  }
+  return SortedBucket(std::move(members), cutoff);
+}
+
+// Verifies the candidate pairs of a tile of a sorted bucket by comparing the
+// strings trimmed by the bucket key. The canonical-part rule runs before the
+// distance if it is the cheaper of the two, after it otherwise.
+template <TrimDirection trim_direction>
+inline void check_entry_tile(
+  const std::vector<std::string_view>& strings,
   int cutoff,
   char metric,
-  str2int& str2idx,
-  str2ints& part2strings,
-  int_pair_set& out
+  const SortedBucket& bucket,
+  const FirstSharedPart& accept,
+  const PairTile& tile,
+  EdgeBuffer& out
 ) {
   distance_k_ptr distance_k = get_distance_k(metric);
-  
-  std::vector<std::pair<std::string, ints>*> entries_small;
-  std::vector<std::pair<std::string, ints>*> entries_large;
-  for (auto& entry : part2strings)
-    if (entry.second.size() < OMP_SIM_SEARCH_THRESHOLD)
-      entries_small.push_back(&entry);
-    else
-      entries_large.push_back(&entry);
-  
-  // PROCESS SMALL ENTRIES USING EXTENAL THREADING 
-  #pragma omp parallel 
-  {
-  double wtime = omp_get_wtime();
-  int thread_id = omp_get_thread_num();
-  #pragma omp for schedule(dynamic,1) nowait
-  for (size_t i = 0; i < entries_small.size(); ++i) {
-    const auto* entry = entries_small[i];
-    int part_len = entry->first.size();
-    if (entry->second.size() == 1)
-      out.insert({entry->second[0], entry->second[0]});
-    else if (entry->second.size() < SIM_SEARCH_THRESHOLD) {
-      const ints *string_indeces = &(entry->second);
-      std::vector<std::string> trimmed_strings(string_indeces->size());
-      if (trim_direction == TrimDirection::Mid || (trim_direction == TrimDirection::End && metric == 'H')) {
-        if (trim_direction == TrimDirection::Mid) {
-          MidTrimFunc midTrim = getMidTrimFunc(metric);
-          for (size_t i = 0; i < string_indeces->size(); i++)
-            trimmed_strings[i] = midTrim(strings[string_indeces->at(i)], entry->first);
-        } else
-          for (size_t i = 0; i < string_indeces->size(); i++)
-            trimmed_strings[i] = trimString<trim_direction>(strings[string_indeces->at(i)], part_len);
-        for (size_t i = 0; i < string_indeces->size(); i++) {
-          for (size_t j = i; j < string_indeces->size(); j++) {
-            std::string trim_str1 = trimmed_strings[i];
-            size_t str_idx1 = string_indeces->at(i);
-            if (i == j) {
-              out.insert({str_idx1, str_idx1});
-              continue;
-            }
-            std::string str1 = strings[str_idx1];
-            std::string trim_str2 = trimmed_strings[j];
-            size_t str_idx2 = string_indeces->at(j);
-            std::string str2 = strings[str_idx2];
-            if (distance_k(trim_str1, trim_str2, cutoff) && distance_k(str1, str2, cutoff)) {
-              if (str_idx1 > str_idx2)
-                out.insert({str_idx2, str_idx1});
-              else
-                out.insert({str_idx1, str_idx2});
-            }
-          }
-        }
-      } else {
-        for (size_t i = 0; i < string_indeces->size(); i++)
-          trimmed_strings[i] = trimString<trim_direction>(strings[string_indeces->at(i)], part_len);
-        for (size_t i = 0; i < string_indeces->size(); i++) {
-          for (size_t j = i; j < string_indeces->size(); j++) {
-            std::string trim_str1 = trimmed_strings[i];
-            size_t str_idx1 = string_indeces->at(i);
-            if (i == j) {
-              out.insert({str_idx1, str_idx1});
-              continue;
-            }
-            std::string trim_str2 = trimmed_strings[j];
-            size_t str_idx2 = string_indeces->at(j);
-            if (distance_k(trim_str1, trim_str2, cutoff)) {
-              if (str_idx1 > str_idx2)
-                out.insert({str_idx2, str_idx1});
-              else
-                out.insert({str_idx1, str_idx2});
-            }
-          }
-        }
-      } 
-    } else {
-      sim_search_semi_patterns_impl<trim_direction>(
-        strings, cutoff, metric, str2idx, out, &entry->second, false, entry->first);
+  bool check_full = trim_direction == TrimDirection::Mid || (trim_direction == TrimDirection::End && metric == 'H');
+  // members of a tile's rows have similar lengths
+  bool accept_first = accept.runs_first(cutoff, strings[bucket.members[tile.row_end - 1].str_idx].size());
+  bucket.for_each_candidate(cutoff, tile, [&](const BucketMember& member1, const BucketMember& member2) {
+    int str_idx1 = member1.str_idx;
+    int str_idx2 = member2.str_idx;
+    if (out.connected(str_idx1, str_idx2) || (accept_first && !accept(str_idx1, str_idx2)))
+      return;
+    if (distance_k(member1.trimmed, member2.trimmed, cutoff) &&
+        (!check_full || distance_k(strings[str_idx1], strings[str_idx2], cutoff)) &&
+        (accept_first || accept(str_idx1, str_idx2))) {
+      if (str_idx1 > str_idx2)
+        out.insert({str_idx2, str_idx1});
+      else
+        out.insert({str_idx1, str_idx2});
     }
+  });
+}
+
+// Semi-patterns are only generated for cutoffs 1 and 2, buckets of larger
+// cutoffs are always verified pair by pair.
+inline bool semi_patterns_supported(int cutoff) {
+  return cutoff <= 2;
+}
+
+// Joins `strings` with the (cutoff + 1)-part scheme and inserts every pair
+// within the cutoff into `out` once. Can be called from a task.
+void join_parts(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
+  char metric,
+  EdgeBuffer& out
+);
+
+// Splitting only pays off if the parts of the remainders are still
+// selective: short parts put most of the bucket into each sub-bucket.
+constexpr size_t SPLIT_MIN_PART_LEN = 5;
+
+// Members of a Start (End) bucket share the key as their prefix (suffix), so
+// the distance of two members equals the distance of their remainders; for
+// Hamming distance of End buckets it is only bounded by it. Buckets are split
+// only if every remainder is non-empty, so each level shortens the strings.
+template <TrimDirection trim_direction>
+inline bool split_supported(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
+  const std::pair<std::string, ints>& entry
+) {
+  if (trim_direction != TrimDirection::Start && trim_direction != TrimDirection::End)
+    return false;
+  if (entry.first.empty() || entry.second.size() < SPLIT_SIM_SEARCH_THRESHOLD)
+    return false;
+  size_t total_len = 0;
+  for (int str_idx: entry.second) {
+    if (strings[str_idx].size() == entry.first.size())
+      return false;
+    total_len += strings[str_idx].size() - entry.first.size();
   }
-  wtime = omp_get_wtime() - wtime;
-  printf("thread_small=%d: %f\n", thread_id, wtime);
+  return total_len >= SPLIT_MIN_PART_LEN * (cutoff + 1) * entry.second.size();
+}
+
+// Instead of indexing an oversized bucket, joins the remainders of its members
+// recursively with the same pigeonhole partition and maps the pairs back.
+template <TrimDirection trim_direction>
+inline void check_split_entry(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
+  char metric,
+  const std::pair<std::string, ints>& entry,
+  const FirstSharedPart& accept,
+  EdgeBuffer& out
+) {
+  int part_len = entry.first.size();
+  std::vector<std::string_view> remainders;
+  remainders.reserve(entry.second.size());
+  for (int str_idx: entry.second)
+    remainders.push_back(trimString<trim_direction>(strings[str_idx], part_len));
+  EdgeBuffer remainder_pairs;
+  join_parts(remainders, cutoff, metric, remainder_pairs);
+  remainder_pairs.finalize();
+
+  distance_k_ptr distance_k = get_distance_k(metric);
+  bool check_full = trim_direction == TrimDirection::End && metric == 'H';
+  bool accept_first = accept.runs_first(cutoff, strings[entry.second[0]].size());
+  for (uint64_t edge: remainder_pairs.edges()) {
+    auto [i, j] = EdgeBuffer::unpack(edge);
+    int str_idx1 = entry.second[i];
+    int str_idx2 = entry.second[j];
+    if (out.connected(str_idx1, str_idx2) || (accept_first && !accept(str_idx1, str_idx2)))
+      continue;
+    if ((!check_full || distance_k(strings[str_idx1], strings[str_idx2], cutoff)) &&
+        (accept_first || accept(str_idx1, str_idx2))) {
+      if (str_idx1 > str_idx2)
+        out.insert({str_idx2, str_idx1});
+      else
+        out.insert({str_idx1, str_idx2});
+    }
   }
+}
+
+template <TrimDirection trim_direction>
+inline void check_small_entry(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
+  char metric,
+  const std::pair<std::string, ints>& entry,
+  int n_parts,
+  int part,
+  EdgeBuffer& out
+) {
+  FirstSharedPart accept{strings, n_parts, part, metric, entry.first};
+  size_t size = entry.second.size();
+  if (size == 1)
+    return;
+  else if (split_supported<trim_direction>(strings, cutoff, entry))
+    check_split_entry<trim_direction>(strings, cutoff, metric, entry, accept, out);
+  else if (size < SIM_SEARCH_THRESHOLD || !semi_patterns_supported(cutoff))
+    check_entry_tile<trim_direction>(
+      strings, cutoff, metric, sort_bucket<trim_direction>(strings, cutoff, metric, entry), accept, {0, size, 0, size}, out);
+  else
+    sim_search_semi_patterns_impl<trim_direction>(
+      strings, cutoff, metric, out, &entry.second, false, entry.first, accept);
+}
 
-  auto start = std::chrono::high_resolution_clock::now();
-  // PROCESS LARGE ENTRIES USING INTERNAL THREADING
-  for (size_t i = 0; i < entries_large.size(); i++) {
-    const auto* entry = entries_large[i];
-          auto start = std::chrono::high_resolution_clock::now();
-    std::cout << "out size " << out.size() << std::endl;
+template <TrimDirection trim_direction>
+inline void check_large_entry(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
+  char metric,
+  const std::pair<std::string, ints>& entry,
+  int n_parts,
+  int part,
+  EdgeBuffer& out
+) {
+  FirstSharedPart accept{strings, n_parts, part, metric, entry.first};
+  if (split_supported<trim_direction>(strings, cutoff, entry))
+    check_split_entry<trim_direction>(strings, cutoff, metric, entry, accept, out);
+  else if (semi_patterns_supported(cutoff))
     sim_search_semi_patterns_omp_impl<trim_direction>(
-      strings, cutoff, metric, str2idx, out, &entry->second, false, entry->first);
-    std::cout << "out size " << out.size() << std::endl;
-          auto end = std::chrono::high_resolution_clock::now();
-          std::chrono::duration<double> elapsed_seconds = end - start;
-          printf("large entry size=%ld: %f\n", entry->second.size(), elapsed_seconds.count());
+      strings, cutoff, metric, out, &entry.second, false, entry.first, accept);
+  else {
+    SortedBucket bucket = sort_bucket<trim_direction>(strings, cutoff, metric, entry);
+    std::vector<PairTile> tiles = bucket.window_tiles();
+    #pragma omp taskloop grainsize(1) shared(strings, bucket, accept, tiles, out)
+    for (size_t tile = 0; tile < tiles.size(); tile++)
+      check_entry_tile<trim_direction>(strings, cutoff, metric, bucket, accept, tiles[tile], out);
   }
-  auto end = std::chrono::high_resolution_clock::now();
-  std::chrono::duration<double> elapsed_seconds = end - start;
-  printf("large total: %f\n", elapsed_seconds.count());
+}
+
+using BucketCheckFunc = void(*)(
+  const std::vector<std::string_view>&, int, char, const std::pair<std::string, ints>&, int, int, EdgeBuffer&);
+
+struct BucketTask {
+  double cost;
+  int n_parts;
+  int part;
+  BucketCheckFunc check;
+  const std::pair<std::string, ints>* entry;
+};
+
+// Appends every bucket of `part2strings` to `tasks` together with its
+// estimated verification cost; nothing is verified until check_buckets.
+template <TrimDirection trim_direction>
+inline void check_part(
+  const std::vector<std::string_view>& strings,
+  const str2ints& part2strings,
+  int n_parts,
+  int part,
+  std::vector<BucketTask>& tasks
+) {
+  for (const auto& entry : part2strings) {
+    double cost = bucket_cost(strings, entry.second, entry.first.size());
+    if (entry.second.size() < OMP_SIM_SEARCH_THRESHOLD)
+      tasks.push_back({cost, n_parts, part, check_small_entry<trim_direction>, &entry});
+    else
+      tasks.push_back({cost, n_parts, part, check_large_entry<trim_direction>, &entry});
+  }
+}
+
+// Hands out the sorted buckets as tasks of similar total cost of the
+// current team.
+inline void check_bucket_chunks(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
+  char metric,
+  const std::vector<BucketTask>& tasks,
+  const std::vector<double>& costs,
+  EdgeBuffer& out
+) {
+  std::vector<size_t> bounds = cost_partition(costs, COST_CHUNKS_PER_THREAD * omp_get_num_threads());
+  #pragma omp taskloop grainsize(1) shared(strings, tasks, out, bounds)
+  for (size_t chunk = 0; chunk < bounds.size() - 1; chunk++)
+    for (size_t i = bounds[chunk]; i < bounds[chunk + 1]; i++) {
+      const BucketTask& task = tasks[i];
+      task.check(strings, cutoff, metric, *task.entry, task.n_parts, task.part, out);
+    }
+}
+
+// Verifies the buckets collected from all parts inside one parallel region.
+// Buckets are ordered by decreasing estimated cost and handed out as tasks
+// of similar total cost, so the largest buckets never start last. Large
+// buckets split themselves further into nested tasks. Called from a task
+// (a split bucket), the buckets become tasks of the enclosing region.
+inline void check_buckets(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
+  char metric,
+  std::vector<BucketTask>& tasks,
+  EdgeBuffer& out
+) {
+  std::sort(tasks.begin(), tasks.end(), [](const BucketTask& a, const BucketTask& b) {
+    return a.cost > b.cost;
+  });
+  std::vector<double> costs(tasks.size());
+  for (size_t i = 0; i < tasks.size(); i++)
+    costs[i] = tasks[i].cost;
+
+  if (omp_in_parallel()) {
+    check_bucket_chunks(strings, cutoff, metric, tasks, costs, out);
+    return;
+  }
+
+  #pragma omp parallel
+  #pragma omp single
+  check_bucket_chunks(strings, cutoff, metric, tasks, costs, out);
 }
 
 int sim_search_part_patterns(
   std::string file_name,
   int cutoff,
   char metric,
-  bool include_duplicates
+  const InputOptions& input,
+  const OutputOptions& output
 );
 
 
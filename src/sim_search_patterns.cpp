@@ -1,52 +1,84 @@
 #include "sim_search_patterns.hpp"
 
-void sim_search_patterns(
+// Every pair of a pattern bucket is within the cutoff: emits the pairs of one
+// tile of the bucket without verification.
+static void emit_bucket_pairs(
+  const ints& positions,
+  const PairTile& tile,
+  EdgeBuffer& out
+) {
+  for_each_tile_pair(tile, [&](size_t i, size_t j) {
+    int str_idx1 = positions[i];
+    int str_idx2 = positions[j];
+    if (str_idx1 < str_idx2)
+      out.insert({str_idx1, str_idx2});
+    else
+      out.insert({str_idx2, str_idx1});
+  });
+}
+
+void sim_search_patterns_omp(
   const std::vector<std::string>& strings,
   int cutoff,
   char metric,
-  str2int& str2idx,
-  int_pair_set& out,
-  ints* strings_subset,
+  EdgeBuffer& out,
   bool include_eye
 ) {
-  str2ints pat2str;
-  map_patterns<TrimDirection::No>(strings, cutoff, metric, str2idx, strings_subset, pat2str);
+  std::vector<GappedView> items;
+  items.reserve(strings.size());
+  for (const std::string& str: strings)
+    items.push_back(str);
+  ShardedPatterns index;
 
-  for (auto entry = pat2str.begin(); entry != pat2str.end(); entry++) {
-    if (entry->second.size() > 1) {
-      for (auto str_idx1 = entry->second.begin(); str_idx1 != entry->second.end(); ++str_idx1) {
-        for (auto str_idx2 = str_idx1 + 1; str_idx2 != entry->second.end(); ++str_idx2) {
-          if (*str_idx1 > *str_idx2) {
-            out.insert({*str_idx2, *str_idx1});
-          } else {  
-            out.insert({*str_idx1, *str_idx2});
-          }
-        }
+  #pragma omp parallel
+  #pragma omp single
+  {
+  map_patterns_sharded(items, cutoff, metric, index);
+  #pragma omp taskloop grainsize(1) shared(index, out)
+  for (size_t shard = 0; shard < index.shards.size(); shard++)
+    for (const auto& entry: index.shards[shard]) {
+      const ints& positions = entry.second;
+      if (positions.size() < 2)
+        continue;
+      if (positions.size() <= PAIR_TILE_SIZE) {
+        emit_bucket_pairs(positions, {0, positions.size(), 0, positions.size()}, out);
+        continue;
       }
+      std::vector<PairTile> tiles = triangle_tiles(positions.size());
+      #pragma omp taskloop grainsize(1) shared(positions, tiles, out)
+      for (size_t tile = 0; tile < tiles.size(); tile++)
+        emit_bucket_pairs(positions, tiles[tile], out);
     }
   }
 
   if (include_eye)
+    #pragma omp parallel for
     for (size_t i = 0; i < strings.size(); i++)
       out.insert({i, i});
 }
 
-
 int sim_search_patterns(
   std::string file_name,
   int cutoff,
   char metric,
-  bool include_duplicates
+  const InputOptions& input,
+  const OutputOptions& output
 ) {
-  std::vector<std::string> strings;
-  str2int str2idx;
-  str2ints str2idxs;
-  readFile(file_name, strings, str2idx, include_duplicates, str2idxs);
-
-  int_pair_set out;
+  SequenceTable table;
+  // patterns exist only for some cutoffs: fail before any thread is started
+  getPatternFunc(cutoff, metric);
+  readFile(file_name, input, table);
+  const std::vector<std::string>& strings = table.strings;
 
-  sim_search_patterns(strings, cutoff, metric, str2idx, out, nullptr, true);
   std::string out_file_name = file_name + "_p_" + std::to_string(cutoff) + "_" + metric;
-  writeFile(out_file_name, out, strings, str2idxs, include_duplicates);
+  // a pair is emitted once per shared pattern, so it can only be written or
+  // counted after deduplication (main rejects streaming); components accept
+  // repeated pairs
+  EdgeStream* stream = nullptr;
+  std::unique_ptr<EdgeSummary> summary = openEdgeSummary(table, output);
+  EdgeBuffer out(nullptr, output.mode == OutputMode::Components ? summary.get() : nullptr);
+
+  sim_search_patterns_omp(strings, cutoff, metric, out, true);
+  writeEdges(out_file_name, out, stream, summary.get(), table, output);
   return 0;
 }
\ No newline at end of file
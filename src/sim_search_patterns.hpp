@@ -7,15 +7,17 @@
 #include "file_io.hpp"
 #include "patterns_generators.hpp"
 #include "trim_strings.hpp"
+#include "pair_tiles.hpp"
 
 
-void sim_search_patterns(
+// Multithreaded variant over all distinct strings: patterns are indexed in
+// shards by pattern hash and the pairs of every shard are emitted by its own
+// task, giant buckets split into tiles.
+void sim_search_patterns_omp(
   const std::vector<std::string>& strings,
   int cutoff,
   char metric,
-  str2int& str2idx,
-  int_pair_set& out,
-  ints* strings_subset = nullptr,
+  EdgeBuffer& out,
   bool include_eye = true
 );
 
@@ -23,7 +25,8 @@ int sim_search_patterns(
   std::string file_name,
   int cutoff,
   char metric,
-  bool include_duplicates
+  const InputOptions& input,
+  const OutputOptions& output
 );
 
 
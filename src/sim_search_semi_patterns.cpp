@@ -1,19 +1,44 @@
-#include "sim_search_semi_patterns.hpp"
+#include "sim_search_semi_patterns_impl.hpp"
+#include "sim_search_part_patterns.hpp"
+
+// The searches are instantiated here only: the partition engine runs them on
+// its buckets with the canonical-part filter for every trim direction it uses.
+#define INSTANTIATE_SEMI_PATTERNS(trim_direction, PairFilter) \
+  template void sim_search_semi_patterns_omp_impl<trim_direction, PairFilter>( \
+    const std::vector<std::string_view>&, int, char, EdgeBuffer&, \
+    const ints*, bool, const std::string&, const PairFilter&); \
+  template void sim_search_semi_patterns_impl<trim_direction, PairFilter>( \
+    const std::vector<std::string_view>&, int, char, EdgeBuffer&, \
+    const ints*, bool, const std::string&, const PairFilter&);
+
+INSTANTIATE_SEMI_PATTERNS(TrimDirection::No, AcceptAllPairs)
+INSTANTIATE_SEMI_PATTERNS(TrimDirection::Start, FirstSharedPart)
+INSTANTIATE_SEMI_PATTERNS(TrimDirection::No, FirstSharedPart)
+INSTANTIATE_SEMI_PATTERNS(TrimDirection::End, FirstSharedPart)
 
 int sim_search_semi_patterns(
   std::string file_name,
   int cutoff,
   char metric,
-  bool include_duplicates
+  const InputOptions& input,
+  const OutputOptions& output
 ) {
-  std::vector<std::string> strings;
-  str2int str2idx;
-  str2ints str2idxs;
-  readFile(file_name, strings, str2idx, include_duplicates, str2idxs);
+  SequenceTable table;
+  // patterns exist only for some cutoffs: fail before any thread is started
+  getPatternFunc(cutoff, 'S');
+  readFile(file_name, input, table);
+  std::vector<std::string_view> strings = table.views();
 
-  int_pair_set out;
-  sim_search_semi_patterns_impl<TrimDirection::No>(strings, cutoff, metric, str2idx, out, nullptr, true);
   std::string out_file_name = file_name + "_sp_" + std::to_string(cutoff) + "_" + metric;
-  writeFile(out_file_name, out, strings, str2idxs, include_duplicates);
+  std::unique_ptr<EdgeStream> stream = openEdgeStream(out_file_name, table, output);
+  std::unique_ptr<EdgeSummary> summary = openEdgeSummary(table, output);
+  EdgeBuffer out(stream.get(), summary.get());
+  #pragma omp parallel
+  #pragma omp single
+  sim_search_semi_patterns_omp_impl<TrimDirection::No>(strings, cutoff, metric, out, nullptr, false);
+  #pragma omp parallel for
+  for (size_t i = 0; i < strings.size(); i++)
+    out.insert({i, i});
+  writeEdges(out_file_name, out, stream.get(), summary.get(), table, output);
   return 0;
 }
\ No newline at end of file
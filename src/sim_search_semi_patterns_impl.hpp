@@ -0,0 +1,271 @@
+#ifndef SIM_SEARCH_SEMI_PATTERNS_IMPL_H
+#define SIM_SEARCH_SEMI_PATTERNS_IMPL_H
+
+// Definitions of the semi-pattern searches. gtl/bit_vector.hpp defines a
+// non-inline function, so only sim_search_semi_patterns.cpp includes this
+// header; it instantiates the searches for every filter they are run with.
+
+#include "sim_search_semi_patterns.hpp"
+#include "pair_tiles.hpp"
+#include "../thirdparty/gtl/bit_vector.hpp"
+
+// Members of a search: the subset, or all (distinct) strings of the input.
+inline std::vector<int> semi_pattern_members(
+  const std::vector<std::string_view>& strings,
+  const ints* strings_subset
+) {
+  if (strings_subset != nullptr)
+    return std::vector<int>(strings_subset->begin(), strings_subset->end());
+  std::vector<int> members(strings.size());
+  std::iota(members.begin(), members.end(), 0);
+  return members;
+}
+
+template <TrimDirection trim_direction>
+inline std::vector<GappedView> trim_members(
+  const std::vector<std::string_view>& strings,
+  const std::vector<int>& members,
+  const std::string& trim_part,
+  char metric
+) {
+  std::vector<GappedView> trimmed;
+  trimmed.reserve(members.size());
+  for (int str_idx: members)
+    trimmed.push_back(trimPart<trim_direction>(strings[str_idx], trim_part, metric));
+  return trimmed;
+}
+
+// Verifies the members at `pos1` and `pos2` and inserts them if they are
+// within the cutoff and pass the filter, run first or last.
+template <typename PairFilter>
+inline void check_pair(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
+  distance_k_ptr distance_k,
+  bool check_full,
+  const std::vector<int>& members,
+  const std::vector<GappedView>& trimmed,
+  size_t pos1,
+  size_t pos2,
+  const PairFilter& accept,
+  bool accept_first,
+  EdgeBuffer& out
+) {
+  int str_idx1 = members[pos1];
+  int str_idx2 = members[pos2];
+  if (out.connected(str_idx1, str_idx2) || (accept_first && !accept(str_idx1, str_idx2)))
+    return;
+  bool close = check_full
+    ? distance_k(strings[str_idx1], strings[str_idx2], cutoff)
+    : distance_k(trimmed[pos1], trimmed[pos2], cutoff);
+  if (close && (accept_first || accept(str_idx1, str_idx2))) {
+    if (str_idx1 < str_idx2)
+      out.insert({str_idx1, str_idx2});
+    else
+      out.insert({str_idx2, str_idx1});
+  }
+}
+
+// Verifies the candidates collected for the member at `pos` and clears their
+// visited bits. Candidates are collected once per query, so every pair
+// sharing any number of patterns is verified and emitted once. The filter
+// runs before the distance if it is the cheaper of the two, after it otherwise.
+template <typename PairFilter>
+inline void check_candidates(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
+  distance_k_ptr distance_k,
+  bool check_full,
+  const std::vector<int>& members,
+  const std::vector<GappedView>& trimmed,
+  size_t pos,
+  std::vector<int>& candidates,
+  gtl::bit_vector& visited,
+  const PairFilter& accept,
+  EdgeBuffer& out
+) {
+  bool accept_first = candidates.empty() || accept.runs_first(cutoff, strings[members[pos]].size());
+  for (int candidate: candidates) {
+    visited.reset(candidate);
+    check_pair(strings, cutoff, distance_k, check_full, members, trimmed, pos, candidate, accept, accept_first, out);
+  }
+  candidates.clear();
+}
+
+// Pattern buckets of at least this many members are verified as tiles of
+// their pair triangle instead of by the queries of their members.
+constexpr size_t TILED_PATTERN_BUCKET_SIZE = 4 * PAIR_TILE_SIZE;
+
+// Flag of a tiled bucket in the bucket lists of the members: it orders tiled
+// buckets after all others.
+constexpr uint64_t TILED_BUCKET = uint64_t(1) << 63;
+
+// Whether `bucket` is the first bucket the two sorted bucket lists share.
+inline bool first_shared_bucket(
+  std::span<const uint64_t> buckets1,
+  std::span<const uint64_t> buckets2,
+  uint64_t bucket
+) {
+  auto it1 = buckets1.begin(), it2 = buckets2.begin();
+  while (*it1 != *it2)
+    if (*it1 < *it2)
+      ++it1;
+    else
+      ++it2;
+  return *it1 == bucket;
+}
+
+// Task-parallel variant: every phase is a taskloop over the current team, so
+// it is meant to be called from a task inside an enclosing parallel region.
+// Patterns are indexed in shards by pattern hash; the index keeps the buckets
+// of every member, so a query scans them without regenerating its patterns.
+// Queries skip buckets of TILED_PATTERN_BUCKET_SIZE members or more: their
+// pair triangles are split into tiles verified as nested tasks. A pair is
+// verified in the first bucket it shares, with tiled buckets ordered last,
+// so it is still verified and emitted once.
+template <TrimDirection trim_direction, typename PairFilter>
+void sim_search_semi_patterns_omp_impl(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
+  char metric,
+  EdgeBuffer& out,
+  const ints* strings_subset,
+  bool include_eye,
+  const std::string &trim_part,
+  const PairFilter& accept
+) {
+  std::vector<int> members = semi_pattern_members(strings, strings_subset);
+  std::vector<GappedView> trimmed = trim_members<trim_direction>(strings, members, trim_part, metric);
+  ShardedPatterns index;
+  map_patterns_sharded(trimmed, cutoff, 'S', index, true);
+
+  // flags the tiled buckets of every member, sorts them last and counts the
+  // buckets a query scans
+  std::vector<double> costs(members.size());
+  std::vector<size_t> queried_end(members.size());
+  #pragma omp taskloop shared(index, costs, queried_end)
+  for (size_t pos = 0; pos < members.size(); pos++) {
+    uint64_t* buckets = index.item_buckets.data() + index.item_begin[pos];
+    uint64_t* buckets_end = index.item_buckets.data() + index.item_begin[pos + 1];
+    costs[pos] = 1;
+    for (uint64_t* bucket = buckets; bucket != buckets_end; bucket++) {
+      size_t size = index.bucket(*bucket).size();
+      if (size >= TILED_PATTERN_BUCKET_SIZE)
+        *bucket |= TILED_BUCKET;
+      else
+        costs[pos] += size;
+    }
+    std::sort(buckets, buckets_end);
+    queried_end[pos] = std::lower_bound(buckets, buckets_end, TILED_BUCKET) - index.item_buckets.data();
+  }
+  std::vector<size_t> bounds = cost_partition(costs, COST_CHUNKS_PER_THREAD * omp_get_num_threads());
+
+  distance_k_ptr distance_k = get_distance_k(metric);
+  bool check_full = trim_direction == TrimDirection::Mid || (trim_direction == TrimDirection::End && metric == 'H');
+  #pragma omp taskloop grainsize(1) shared(strings, members, trimmed, index, queried_end, bounds, accept, out)
+  for (size_t chunk = 0; chunk < bounds.size() - 1; chunk++) {
+    gtl::bit_vector visited(members.size());
+    std::vector<int> candidates;
+    for (size_t pos = bounds[chunk]; pos < bounds[chunk + 1]; pos++) {
+      for (size_t b = index.item_begin[pos]; b < queried_end[pos]; b++) {
+        const ints& bucket = index.bucket(index.item_buckets[b]);
+        for (auto candidate = std::upper_bound(bucket.begin(), bucket.end(), static_cast<int>(pos)); candidate != bucket.end(); ++candidate)
+          if (!visited[*candidate]) {
+            visited.set(*candidate);
+            candidates.push_back(*candidate);
+          }
+      }
+      check_candidates(strings, cutoff, distance_k, check_full, members, trimmed, pos, candidates, visited, accept, out);
+    }
+  }
+
+  std::vector<std::vector<uint64_t>> shard_tiled(index.shards.size());
+  #pragma omp taskloop grainsize(1) shared(index, shard_tiled)
+  for (size_t shard = 0; shard < index.shards.size(); shard++) {
+    const auto& values = index.shards[shard].values();
+    for (size_t i = 0; i < values.size(); i++)
+      if (values[i].second.size() >= TILED_PATTERN_BUCKET_SIZE)
+        shard_tiled[shard].push_back(TILED_BUCKET | (uint64_t(shard) << 32) | i);
+  }
+  std::vector<uint64_t> tiled;
+  for (const std::vector<uint64_t>& buckets: shard_tiled)
+    tiled.insert(tiled.end(), buckets.begin(), buckets.end());
+
+  #pragma omp taskloop grainsize(1) shared(strings, members, trimmed, index, tiled, accept, out)
+  for (size_t t = 0; t < tiled.size(); t++) {
+    const ints& bucket = index.bucket(tiled[t] & ~TILED_BUCKET);
+    std::vector<PairTile> tiles = triangle_tiles(bucket.size());
+    #pragma omp taskloop grainsize(1) shared(strings, members, trimmed, index, tiled, bucket, tiles, accept, out)
+    for (size_t tile = 0; tile < tiles.size(); tile++) {
+      bool accept_first = accept.runs_first(cutoff, strings[members[bucket[tiles[tile].row_begin]]].size());
+      for_each_tile_pair(tiles[tile], [&](size_t i, size_t j) {
+        // positions of a bucket are sorted, so bucket[i] < bucket[j]
+        if (first_shared_bucket(index.buckets_of(bucket[i]), index.buckets_of(bucket[j]), tiled[t]))
+          check_pair(strings, cutoff, distance_k, check_full, members, trimmed, bucket[i], bucket[j], accept, accept_first, out);
+      });
+    }
+  }
+
+  #pragma omp taskloop grainsize(1) shared(index)
+  for (size_t shard = 0; shard < index.shards.size(); shard++)
+    index.shards[shard].clear();
+
+  if (include_eye)
+    for (size_t i = 0; i < strings.size(); i++)
+      out.insert({i, i});
+}
+
+// Every member is indexed by its deletion patterns first; then each member
+// queries the buckets of its patterns for later members, so a pair sharing
+// several patterns is still verified once.
+template <TrimDirection trim_direction, typename PairFilter>
+void sim_search_semi_patterns_impl(
+  const std::vector<std::string_view>& strings,
+  int cutoff,
+  char metric,
+  EdgeBuffer& out,
+  const ints* strings_subset,
+  bool include_eye,
+  const std::string &trim_part,
+  const PairFilter& accept
+) {
+  std::vector<int> members = semi_pattern_members(strings, strings_subset);
+  std::vector<GappedView> trimmed = trim_members<trim_direction>(strings, members, trim_part, metric);
+  PatternFuncType PatternFunc = getPatternFunc(cutoff, 'S');
+  str2ints pat2pos;
+  std::vector<uint32_t> buckets;
+  std::vector<size_t> buckets_begin(members.size() + 1, 0);
+  for (size_t pos = 0; pos < members.size(); pos++) {
+    for (const auto& pattern: PatternFunc(trimmed[pos], nullptr)) {
+      auto [entry, inserted] = pat2pos.try_emplace(pattern);
+      if (!entry->second.empty() && entry->second.back() == static_cast<int>(pos))
+        continue;
+      entry->second.push_back(pos);
+      buckets.push_back(entry - pat2pos.begin());
+    }
+    buckets_begin[pos + 1] = buckets.size();
+  }
+
+  distance_k_ptr distance_k = get_distance_k(metric);
+  bool check_full = trim_direction == TrimDirection::Mid || (trim_direction == TrimDirection::End && metric == 'H');
+  gtl::bit_vector visited(members.size());
+  std::vector<int> candidates;
+  for (size_t pos = 0; pos < members.size(); pos++) {
+    for (size_t b = buckets_begin[pos]; b < buckets_begin[pos + 1]; b++) {
+      const ints& bucket = pat2pos.values()[buckets[b]].second;
+      for (auto candidate = std::upper_bound(bucket.begin(), bucket.end(), static_cast<int>(pos)); candidate != bucket.end(); ++candidate)
+        if (!visited[*candidate]) {
+          visited.set(*candidate);
+          candidates.push_back(*candidate);
+        }
+    }
+    check_candidates(strings, cutoff, distance_k, check_full, members, trimmed, pos, candidates, visited, accept, out);
+  }
+
+  if (include_eye)
+    for (size_t i = 0; i < strings.size(); i++)
+      out.insert({i, i});
+}
+
+
+#endif // SIM_SEARCH_SEMI_PATTERNS_IMPL_H
@@ -0,0 +1,92 @@
+#ifndef SORTED_BUCKET_HPP
+#define SORTED_BUCKET_HPP
+
+#include <vector>
+#include <cstdint>
+#include <bit>
+#include <algorithm>
+#include "gapped_view.hpp"
+#include "pair_tiles.hpp"
+
+// Set of characters of a string folded into 64 bits. Folding only merges
+// characters, so the number of characters missing from the other string can
+// be underestimated but never overestimated.
+inline uint64_t char_signature(const GappedView& str) {
+  uint64_t signature = 0;
+  for (size_t i = 0; i < str.size(); i++)
+    signature |= uint64_t(1) << (static_cast<unsigned char>(str[i]) & 63);
+  return signature;
+}
+
+// Every character present in only one of the strings costs at least one edit
+// (substitution or indel, both for Levenshtein and Hamming distance).
+inline bool signatures_within(uint64_t signature1, uint64_t signature2, int cutoff) {
+  return std::popcount(signature1 & ~signature2) <= cutoff &&
+         std::popcount(signature2 & ~signature1) <= cutoff;
+}
+
+struct BucketMember {
+  int str_idx;
+  int len;
+  uint64_t signature;
+  GappedView trimmed;
+};
+
+// Bucket members ordered by (length, signature). For member i the candidates
+// are the members (i, window_end[i]): longer strings are more than `cutoff`
+// edits away. Members [j, run_end[j]) share length and signature, so a
+// signature mismatch with j rules out the whole run.
+struct SortedBucket {
+  std::vector<BucketMember> members;
+  std::vector<int> window_end;
+  std::vector<int> run_end;
+
+  SortedBucket(std::vector<BucketMember>&& bucket_members, int cutoff)
+    : members(std::move(bucket_members)) {
+    std::sort(members.begin(), members.end(), [](const BucketMember& a, const BucketMember& b) {
+      return a.len != b.len ? a.len < b.len : a.signature < b.signature;
+    });
+    int size = members.size();
+    window_end.resize(size);
+    run_end.resize(size);
+    for (int i = 0, end = 0; i < size; i++) {
+      while (end < size && members[end].len <= members[i].len + cutoff)
+        end++;
+      window_end[i] = end;
+    }
+    for (int j = size - 1; j >= 0; j--) {
+      bool same_run = j + 1 < size && members[j + 1].len == members[j].len &&
+        members[j + 1].signature == members[j].signature;
+      run_end[j] = same_run ? run_end[j + 1] : j + 1;
+    }
+  }
+
+  // Tiles of the pair triangle that hold at least one pair within the
+  // length window.
+  std::vector<PairTile> window_tiles(size_t tile_size = PAIR_TILE_SIZE) const {
+    std::vector<PairTile> tiles;
+    for (const PairTile& tile : triangle_tiles(members.size(), tile_size))
+      if (static_cast<int>(tile.col_begin) < window_end[tile.row_end - 1])
+        tiles.push_back(tile);
+    return tiles;
+  }
+
+  // Calls `visit(member1, member2)` for every candidate pair of a tile that
+  // passes the length and signature filters.
+  template <typename Visit>
+  void for_each_candidate(int cutoff, const PairTile& tile, Visit&& visit) const {
+    for (size_t i = tile.row_begin; i < tile.row_end; i++) {
+      const BucketMember& member1 = members[i];
+      int col_end = std::min(window_end[i], static_cast<int>(tile.col_end));
+      for (int j = static_cast<int>(std::max(tile.col_begin, i + 1)); j < col_end; j++) {
+        if (!signatures_within(member1.signature, members[j].signature, cutoff)) {
+          j = run_end[j] - 1;
+          continue;
+        }
+        visit(member1, members[j]);
+      }
+    }
+  }
+};
+
+#endif // SORTED_BUCKET_HPP
@@ -0,0 +1,93 @@
+#ifndef TEXT_WRITER_HPP
+#define TEXT_WRITER_HPP
+
+#include <omp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Items formatted by one task of the parallel text writer.
+constexpr size_t TEXT_BLOCK_ITEMS = 1 << 16;
+
+inline void appendInt(std::string& buffer, uint64_t value) {
+  char digits[20];
+  auto result = std::to_chars(digits, digits + sizeof(digits), value);
+  buffer.append(digits, result.ptr);
+}
+
+// Appends "first second\n".
+inline void appendLine(std::string& buffer, std::string_view first, std::string_view second) {
+  buffer.append(first);
+  buffer.push_back(' ');
+  buffer.append(second);
+  buffer.push_back('\n');
+}
+
+inline void appendLine(std::string& buffer, uint64_t first, uint64_t second) {
+  appendInt(buffer, first);
+  buffer.push_back(' ');
+  appendInt(buffer, second);
+  buffer.push_back('\n');
+}
+
+// Writes `header` and then the text of `n_items` items to `file_name`.
+// `format(begin, end, buffer)` appends the text of items [begin, end) to
+// `buffer`; a call covers at most TEXT_BLOCK_ITEMS items and starts at a
+// multiple of it. Rounds of blocks are formatted in parallel and every block
+// is written with pwrite at its offset, so at most one round of text is held
+// in memory.
+template <typename Format>
+void writeTextParallel(const std::string& file_name, size_t n_items, Format&& format, std::string_view header = {}) {
+  int fd = ::open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    throw std::runtime_error("Cannot open output file " + file_name);
+  bool header_written = ::pwrite(fd, header.data(), header.size(), 0) == static_cast<ssize_t>(header.size());
+
+  size_t n_blocks = (n_items + TEXT_BLOCK_ITEMS - 1) / TEXT_BLOCK_ITEMS;
+  size_t round_size = 4 * omp_get_max_threads();
+  std::vector<std::string> buffers(round_size);
+  std::vector<off_t> offsets(round_size + 1);
+  std::atomic<bool> failed{!header_written};
+  off_t file_offset = header.size();
+  for (size_t round_begin = 0; round_begin < n_blocks; round_begin += round_size) {
+    size_t round_blocks = std::min(round_size, n_blocks - round_begin);
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t block = 0; block < round_blocks; block++) {
+      size_t begin = (round_begin + block) * TEXT_BLOCK_ITEMS;
+      buffers[block].clear();
+      format(begin, std::min(begin + TEXT_BLOCK_ITEMS, n_items), buffers[block]);
+    }
+    offsets[0] = file_offset;
+    for (size_t block = 0; block < round_blocks; block++)
+      offsets[block + 1] = offsets[block] + buffers[block].size();
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t block = 0; block < round_blocks; block++) {
+      const char* data = buffers[block].data();
+      size_t left = buffers[block].size();
+      off_t offset = offsets[block];
+      while (left > 0) {
+        ssize_t written = ::pwrite(fd, data, left, offset);
+        if (written <= 0) {
+          failed = true;
+          break;
+        }
+        data += written;
+        left -= written;
+        offset += written;
+      }
+    }
+    file_offset = offsets[round_blocks];
+  }
+  ::close(fd);
+  if (failed)
+    throw std::runtime_error("Cannot write output file " + file_name);
+}
+
+#endif // TEXT_WRITER_HPP
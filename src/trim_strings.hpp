@@ -2,6 +2,8 @@
 #define TRIMP_STRINGS_HPP
 
 #include <string>
+#include <string_view>
+#include "gapped_view.hpp"
 
 enum class TrimDirection {
     Start,
@@ -10,84 +12,91 @@ enum class TrimDirection {
     No
 };
 
-template <TrimDirection> std::string trimString(
-  const std::string& str, int trim_size);
+template <TrimDirection> std::string_view trimString(
+  std::string_view str, int trim_size);
 
 template <>
-inline std::string trimString<TrimDirection::Start>(
-  const std::string& str, int trim_size
+inline std::string_view trimString<TrimDirection::Start>(
+  std::string_view str, int trim_size
 ) {
   return str.substr(trim_size);
 }
 
 template <>
-inline std::string trimString<TrimDirection::End>(
-  const std::string& str, int trim_size
+inline std::string_view trimString<TrimDirection::End>(
+  std::string_view str, int trim_size
 ) {
   return str.substr(0, str.size() - trim_size);
 }
 
 template <>
-inline std::string trimString<TrimDirection::No>(
-  const std::string& str, int trim_size [[maybe_unused]]
+inline std::string_view trimString<TrimDirection::No>(
+  std::string_view str, int trim_size [[maybe_unused]]
 ) {
   return str;
 }
 
-inline std::string trimMidLev(
-  const std::string& str, const std::string& substr
+// View of `str` without the characters [gap_start, gap_end).
+inline GappedView cutGap(
+  std::string_view str, size_t gap_start, size_t gap_end
+) {
+  return GappedView(str.substr(0, gap_start), str.substr(gap_end));
+}
+
+inline GappedView trimMidLev(
+  std::string_view str, const std::string& substr
 ) {
   size_t part_len = str.size() / 3;
   size_t residue = str.size() % 3;
   if (part_len == substr.size()) {
     if (residue == 0) {
       if (str.compare(part_len, part_len, substr) == 0)
-        return str.substr(0, part_len) + str.substr(part_len * 2);
+        return cutGap(str, part_len, part_len * 2);
       else 
-        return str.substr(0, part_len - 1) + str.substr(part_len * 2 - 1);
+        return cutGap(str, part_len - 1, part_len * 2 - 1);
     } else if (residue == 1) {
       if (str.compare(part_len, part_len, substr) == 0)
-        return str.substr(0, part_len) + str.substr(part_len * 2);
+        return cutGap(str, part_len, part_len * 2);
       else 
-        return str.substr(0, part_len + 1) + str.substr(part_len * 2 + 1);
+        return cutGap(str, part_len + 1, part_len * 2 + 1);
     } else {
-      return str.substr(0, part_len + 1) + str.substr(part_len * 2 + 1);
+      return cutGap(str, part_len + 1, part_len * 2 + 1);
     }
   } else {
     if (residue == 1) {
-      return str.substr(0, part_len) + str.substr(part_len * 2 + 1);
+      return cutGap(str, part_len, part_len * 2 + 1);
     } else {
       if (str.compare(part_len + 1, part_len + 1, substr) == 0)
-        return str.substr(0, part_len + 1) + str.substr(part_len * 2 + 2);
+        return cutGap(str, part_len + 1, part_len * 2 + 2);
       else 
-        return str.substr(0, part_len) + str.substr(part_len * 2 + 1);
+        return cutGap(str, part_len, part_len * 2 + 1);
     }
   }
 }
 
-inline std::string trimMidHam(
-  const std::string& str, const std::string& substr
+inline GappedView trimMidHam(
+  std::string_view str, const std::string& substr
 ) {
   size_t part_len = str.size() / 3;
   size_t residue = str.size() % 3;
 
   if (part_len == substr.size()) {
     if (residue == 0)  {
-      return str.substr(0, part_len) + str.substr(part_len * 2);
+      return cutGap(str, part_len, part_len * 2);
     } else if (residue == 1) {
       if (str.compare(part_len, part_len, substr) == 0)
-        return str.substr(0, part_len) + str.substr(part_len * 2);
+        return cutGap(str, part_len, part_len * 2);
       else 
-        return str.substr(0, part_len + 1) + str.substr(part_len * 2 + 1);
+        return cutGap(str, part_len + 1, part_len * 2 + 1);
     } else {
-      return str.substr(0, part_len + 1) + str.substr(part_len * 2 + 1);
+      return cutGap(str, part_len + 1, part_len * 2 + 1);
     }
   } else {
-    return str.substr(0, part_len + 1) + str.substr(part_len * 2 + 2);
+    return cutGap(str, part_len + 1, part_len * 2 + 2);
   }
 }
 
-using MidTrimFunc = std::string(*)(const std::string& str, const std::string& substr);
+using MidTrimFunc = GappedView(*)(std::string_view str, const std::string& substr);
 inline MidTrimFunc getMidTrimFunc(char metric) {
   if (metric == 'L')
     return trimMidLev;
@@ -95,4 +104,16 @@ inline MidTrimFunc getMidTrimFunc(char metric) {
     return trimMidHam;
 }
 
+// Trims the bucket key `part` from `str` the way buckets of `trim_direction`
+// are verified.
+template <TrimDirection trim_direction>
+inline GappedView trimPart(
+  std::string_view str, const std::string& part, char metric
+) {
+  if constexpr (trim_direction == TrimDirection::Mid)
+    return getMidTrimFunc(metric)(str, part);
+  else
+    return trimString<trim_direction>(str, part.size());
+}
+
 #endif // TRIMP_STRINGS_HPP
\ No newline at end of file
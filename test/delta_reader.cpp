@@ -0,0 +1,81 @@
+// Checks of the delta edge format, compiled and run by test.py:
+//   delta_reader --round_trip <file>  encodes random sorted pairs in blocks
+//                                     of several sizes with appendDeltaBlock
+//                                     into <file> and decodes them with
+//                                     DeltaEdgeReader;
+//   delta_reader <file>.delta         prints the pairs of the file as
+//                                     `<i> <j>` lines.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/delta_edges.hpp"
+
+static void appendUint64(std::string& buffer, uint64_t value) {
+  appendUint32(buffer, static_cast<uint32_t>(value));
+  appendUint32(buffer, static_cast<uint32_t>(value >> 32));
+}
+
+static int round_trip(const std::string& file_name) {
+  // runs of one to a few pairs, with gaps that need one to five varint bytes
+  std::mt19937_64 rnd(47);
+  std::vector<uint64_t> edges;
+  uint64_t i = 0;
+  while (edges.size() < 100000) {
+    i += rnd() % 3 == 0 ? rnd() % 100000 : rnd() % 2;
+    uint64_t j = rnd() % 100;
+    for (uint64_t run = rnd() % 6; run > 0 && j <= 0xffffffffu && i <= 0xffffffffu; run--) {
+      edges.push_back(i << 32 | j);
+      j += rnd() % 2 == 0 ? 1 + rnd() % 100 : 1 + rnd() % (uint64_t(1) << 30);
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  std::string buffer("PJDELTA\0", 8);
+  appendUint64(buffer, (edges.back() >> 32) + 1);
+  appendUint64(buffer, edges.size());
+  const size_t block_sizes[] = {1, 2, 7, 1000, 65536};
+  for (size_t begin = 0, block = 0; begin < edges.size(); block++) {
+    size_t end = std::min(begin + block_sizes[block % 5], edges.size());
+    appendDeltaBlock(buffer, edges.data() + begin, end - begin);
+    begin = end;
+  }
+  std::ofstream(file_name, std::ios::binary).write(buffer.data(), buffer.size());
+
+  DeltaEdgeReader reader(file_name);
+  if (reader.n_nodes() != (edges.back() >> 32) + 1 || reader.n_edges() != edges.size()) {
+    std::fprintf(stderr, "Wrong header of %s\n", file_name.c_str());
+    return 1;
+  }
+  size_t k = 0;
+  uint32_t i1, j1;
+  for (; reader.next(i1, j1); k++)
+    if (k == edges.size() || (static_cast<uint64_t>(i1) << 32 | j1) != edges[k]) {
+      std::fprintf(stderr, "Wrong pair %zu of %s\n", k, file_name.c_str());
+      return 1;
+    }
+  if (k != edges.size()) {
+    std::fprintf(stderr, "Missing pairs in %s: %zu of %zu\n", file_name.c_str(), k, edges.size());
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc == 3 && std::strcmp(argv[1], "--round_trip") == 0)
+    return round_trip(argv[2]);
+  if (argc != 2) {
+    std::fprintf(stderr, "usage: delta_reader [--round_trip] <file>\n");
+    return 2;
+  }
+  DeltaEdgeReader reader(argv[1]);
+  uint32_t i, j;
+  while (reader.next(i, j))
+    std::printf("%u %u\n", i, j);
+  return 0;
+}
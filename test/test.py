@@ -1,5 +1,8 @@
 import os
+import gzip
+import random
 import shutil
+import struct
 import subprocess
 from itertools import product
 from Levenshtein import hamming
@@ -146,6 +149,769 @@ def check_project(
       assert False
     print('\tDone.')
 
+
+PATTERN_JOIN = '../build/pattern_join'
+
+
+def generate_random_input(
+    name: str,
+    alphabet: str,
+    lengths: tuple,
+    n_seqs: int,
+    seed: int,
+    prefix: str = '',
+    suffix: str = ''
+) -> tuple:
+  # random sequences, each followed by a few close mutants and some duplicates
+  rnd = random.Random(seed)
+  input_seqs = []
+  while len(input_seqs) < n_seqs:
+    seq = ''.join(rnd.choice(alphabet) for _ in range(rnd.randint(*lengths)))
+    input_seqs.append(prefix + seq + suffix)
+    for _ in range(rnd.randint(0, 2)):
+      mutant = list(seq)
+      for _ in range(rnd.randint(1, 3)):
+        pos = rnd.randrange(len(mutant))
+        op = rnd.randint(0, 2)
+        if op == 0:
+          mutant[pos] = rnd.choice(alphabet)
+        elif op == 1 and len(mutant) > 1:
+          del mutant[pos]
+        else:
+          mutant.insert(pos, rnd.choice(alphabet))
+      input_seqs.append(prefix + ''.join(mutant) + suffix)
+  input_seqs += rnd.sample(input_seqs, n_seqs // 10)
+  rnd.shuffle(input_seqs)
+  input_fname = f'./test_data/{name}'
+  with open(input_fname, 'w') as input_file:
+    input_file.write('\n'.join(input_seqs) + '\n')
+  return input_fname, input_seqs
+
+
+def expected_pairs(
+    input_seqs: list[str],
+    dist_name: str,
+    cutoff: int
+) -> set[tuple[str]]:
+  # brute force over all pairs of unique strings, in both orders
+  distance = get_distance(dist_name)
+  unique_seqs = sorted(set(input_seqs))
+  out = set()
+  for i, seq1 in enumerate(unique_seqs):
+    for seq2 in unique_seqs[i:]:
+      if distance(seq1, seq2) <= cutoff:
+        out.add((seq1, seq2))
+        out.add((seq2, seq1))
+  return out
+
+
+def expected_index_pairs(
+    input_seqs: list[str],
+    pairs: set[tuple[str]]
+) -> set[tuple[str]]:
+  # pairs of strings expanded to all pairs of their input lines
+  seq2idxs = {}
+  for idx, seq in enumerate(input_seqs):
+    seq2idxs.setdefault(seq, []).append(str(idx))
+  return {(idx1, idx2) for seq1, seq2 in pairs for idx1 in seq2idxs[seq1] for idx2 in seq2idxs[seq2]}
+
+
+def run_pattern_join(
+    input_fname: str,
+    cutoff: int,
+    dist_name: str,
+    method: str,
+    include_duplicates: str = 'false',
+    *args: str,
+    threads: int = None
+) -> str:
+  dist_param = get_distance_param(dist_name)
+  run_command = [PATTERN_JOIN, '--file_name', input_fname, '--cutoff', str(cutoff),
+                 '--metric_type', dist_param, '--method', method,
+                 '--include_duplicates', include_duplicates, *args]
+  env = dict(os.environ, OMP_NUM_THREADS=str(threads)) if threads else None
+  result = subprocess.run(run_command, text=True, capture_output=True, env=env)
+  assert result.returncode == 0, f'{" ".join(run_command)}\n{result.stderr}'
+  return f'{input_fname}_{get_method_shortcut(method)}_{cutoff}_{dist_param}'
+
+
+def assert_same(got, expected, message: str):
+  if got != expected:
+    if isinstance(got, set):
+      print(list(got - expected)[:10])
+      print('=' * 100)
+      print(list(expected - got)[:10])
+    print(f'Error!!!!!!!\n\t{message}')
+    assert False
+
+
+def check_methods(
+    input_fname: str,
+    input_seqs: list[str],
+    dist_names: tuple,
+    cutoffs: tuple,
+    methods: tuple,
+    *args: str,
+    threads: tuple = (None,)
+):
+  for dist_name in dist_names:
+    for cutoff in cutoffs:
+      expected = expected_pairs(input_seqs, dist_name, cutoff)
+      for method in methods:
+        for n_threads in threads:
+          print(f'\tChecking method: {method}, distance: {dist_name}, cutoff: {cutoff}, threads: {n_threads} {" ".join(args)}')
+          output_fname = run_pattern_join(input_fname, cutoff, dist_name, method, 'false', *args, threads=n_threads)
+          assert_same(read_out(output_fname), expected, f'{input_fname} {method} {dist_name} {cutoff} {n_threads}')
+
+
+def test_partition_threads():
+  print('Testing partition_pattern with several threads')
+  input_fname, input_seqs = generate_random_input('threads', 'ACDEFG', (6, 12), 600, 1)
+  check_methods(input_fname, input_seqs, ('hamming', 'levenshtein'), (1, 2), ('partition_pattern',), threads=(1, 2, 4))
+  print('Done.')
+
+
+def test_skewed_lengths():
+  # a few long strings among many short ones: their buckets cost far more
+  print('Testing inputs with skewed string lengths')
+  _, short_seqs = generate_random_input('short_part', 'ACDEFG', (4, 8), 500, 9)
+  _, long_seqs = generate_random_input('long_part', 'ACDEFG', (40, 60), 60, 10)
+  input_seqs = short_seqs + long_seqs
+  input_fname = './test_data/skewed'
+  with open(input_fname, 'w') as input_file:
+    input_file.write('\n'.join(input_seqs) + '\n')
+  check_methods(input_fname, input_seqs, ('hamming', 'levenshtein'), (1, 2),
+                ('pattern', 'semi_pattern', 'partition_pattern'), threads=(1, 4))
+  print('Done.')
+
+
+def check_exactly_once(
+    input_fname: str,
+    input_seqs: list[str],
+    dist_name: str,
+    cutoff: int,
+    method: str
+):
+  # streamed pairs are written as they are found: a pair verified twice
+  # shows up as a repeated line
+  expected = expected_pairs(input_seqs, dist_name, cutoff)
+  output_fname = run_pattern_join(input_fname, cutoff, dist_name, method, 'false', '--stream', 'true', threads=4)
+  with open(output_fname) as f:
+    pairs = [tuple(sorted(line.split())) for line in f]
+  assert_same(len(pairs), len(set(pairs)), f'{input_fname} {method} {dist_name} {cutoff}: repeated pairs')
+  assert_same(read_out(output_fname), expected, f'{input_fname} {method} {dist_name} {cutoff}')
+
+
+def test_partition_exactly_once():
+  # strings sharing several parts are found in the bucket of each of them
+  print('Testing that partition_pattern emits every pair once')
+  input_fname, input_seqs = generate_random_input('partition_once', 'ACD', (6, 10), 600, 11)
+  for dist_name in ('hamming', 'levenshtein'):
+    for cutoff in (1, 2, 3):
+      print(f'\tChecking distance: {dist_name}, cutoff: {cutoff}')
+      check_exactly_once(input_fname, input_seqs, dist_name, cutoff, 'partition_pattern')
+  print('Done.')
+
+
+def test_short_strings():
+  # strings shorter than the number of parts leave empty parts and remainders
+  print('Testing strings of one to four letters')
+  input_fname, input_seqs = generate_random_input('short', 'ACG', (1, 4), 300, 12)
+  check_methods(input_fname, input_seqs, ('hamming', 'levenshtein'), (1, 2),
+                ('pattern', 'semi_pattern', 'partition_pattern'))
+  print('Done.')
+
+
+def test_partition_cutoffs():
+  print('Testing partition_pattern for cutoffs 3 and 4')
+  input_fname, input_seqs = generate_random_input('partition', 'ACDE', (8, 14), 300, 1)
+  check_methods(input_fname, input_seqs, ('hamming', 'levenshtein'), (3, 4), ('partition_pattern',))
+  print('Done.')
+
+
+def test_length_windows():
+  # every string shares its prefix, so the first part's bucket holds strings
+  # of all lengths and only a window of them is compared with each string
+  print('Testing buckets of strings with many lengths')
+  input_fname, input_seqs = generate_random_input('windows', 'ACDEFG', (2, 16), 800, 13, prefix='CASS')
+  check_methods(input_fname, input_seqs, ('hamming', 'levenshtein'), (1, 2), ('partition_pattern',))
+  print('Done.')
+
+
+def generate_oversized_input() -> tuple:
+  # SPLIT_SIM_SEARCH_THRESHOLD = 2000 in main.cpp: every string of a group
+  # shares its first (last) 14 of about 20 letters, so the Start (End) bucket
+  # of the first (last) part holds the whole group and is split
+  _, start_seqs = generate_random_input('start', 'ACDEFG', (6, 6), 2500, 2, prefix='CASSLAPGATGELF')
+  _, end_seqs = generate_random_input('end', 'ACDEFG', (6, 6), 2500, 3, suffix='SYNEQFFGPGTRLT')
+  input_seqs = start_seqs + end_seqs
+  input_fname = './test_data/oversized'
+  with open(input_fname, 'w') as input_file:
+    input_file.write('\n'.join(input_seqs) + '\n')
+  return input_fname, input_seqs
+
+
+def test_oversized_buckets():
+  print('Testing buckets larger than SPLIT_SIM_SEARCH_THRESHOLD')
+  input_fname, input_seqs = generate_oversized_input()
+  check_methods(input_fname, input_seqs, ('hamming', 'levenshtein'), (1,),
+                ('pattern', 'semi_pattern', 'partition_pattern'))
+  print('Done.')
+
+
+def test_giant_semi_buckets():
+  # every string is the same 13 letters with two letters inserted, so the
+  # semi pattern of the 13 letters is shared by all of them and its bucket
+  # is far above TILED_PATTERN_BUCKET_SIZE
+  print('Testing semi-pattern buckets verified as tiles')
+  rnd = random.Random(14)
+  template = 'CASSLAPGTEQYF'
+  input_seqs = set()
+  while len(input_seqs) < 1500:
+    seq = list(template)
+    for _ in range(2):
+      seq.insert(rnd.randint(0, len(seq)), rnd.choice('ACDEFGHIKLMNPQRSTVWY'))
+    input_seqs.add(''.join(seq))
+  input_seqs = sorted(input_seqs)
+  rnd.shuffle(input_seqs)
+  input_fname = './test_data/giant'
+  with open(input_fname, 'w') as input_file:
+    input_file.write('\n'.join(input_seqs) + '\n')
+  check_methods(input_fname, input_seqs, ('levenshtein',), (1, 2), ('semi_pattern',), threads=(1, 4))
+  check_exactly_once(input_fname, input_seqs, 'levenshtein', 2, 'semi_pattern')
+  print('Done.')
+
+
+def test_semi_exactly_once():
+  # close strings share several deletion patterns
+  print('Testing that semi_pattern emits every pair once')
+  input_fname, input_seqs = generate_random_input('semi_once', 'ACD', (6, 10), 600, 15)
+  for dist_name in ('hamming', 'levenshtein'):
+    for cutoff in (1, 2):
+      print(f'\tChecking distance: {dist_name}, cutoff: {cutoff}')
+      check_exactly_once(input_fname, input_seqs, dist_name, cutoff, 'semi_pattern')
+  print('Done.')
+
+
+def test_pattern_threads():
+  print('Testing pattern with several threads')
+  input_fname, input_seqs = generate_random_input('pattern_threads', 'ACDEFG', (6, 12), 600, 16)
+  check_methods(input_fname, input_seqs, ('hamming', 'levenshtein'), (1, 2), ('pattern',), threads=(1, 2, 4))
+  print('Done.')
+
+
+def test_semi_pattern_threads():
+  print('Testing semi_pattern with several threads')
+  input_fname, input_seqs = generate_random_input('semi_threads', 'ACDEFG', (6, 12), 600, 17)
+  check_methods(input_fname, input_seqs, ('hamming', 'levenshtein'), (1, 2), ('semi_pattern',), threads=(1, 2, 4))
+  print('Done.')
+
+
+def test_sorted_output():
+  # pairs are written once, sorted by the ids of their strings (numbered in
+  # the order of their first input line), whatever the number of threads
+  print('Testing sorted and deterministic output')
+  input_fname, input_seqs = generate_random_input('sorted', 'ACDEFG', (6, 12), 600, 18)
+  seq2id = {seq: idx for idx, seq in enumerate(dict.fromkeys(input_seqs))}
+  for method in ('pattern', 'semi_pattern', 'partition_pattern'):
+    print(f'\tChecking method: {method}')
+    outputs = []
+    for n_threads in (1, 4):
+      output_fname = run_pattern_join(input_fname, 2, 'levenshtein', method, threads=n_threads)
+      with open(output_fname) as f:
+        outputs.append(f.read())
+    assert_same(outputs[0], outputs[1], f'{input_fname} {method}: output depends on the number of threads')
+    ids = [tuple(seq2id[seq] for seq in line.split()) for line in outputs[0].splitlines()]
+    assert_same(all(id1 <= id2 for id1, id2 in ids), True, f'{input_fname} {method}: unordered pair')
+    assert_same(ids, sorted(set(ids)), f'{input_fname} {method}: unsorted or repeated pairs')
+  print('Done.')
+
+
+def test_stream():
+  print('Testing --stream true')
+  input_fname, input_seqs = generate_random_input('stream', 'ACDEFG', (6, 12), 500, 4)
+  check_methods(input_fname, input_seqs, ('hamming', 'levenshtein'), (1, 2),
+                ('semi_pattern', 'partition_pattern'), '--stream', 'true')
+  result = subprocess.run([PATTERN_JOIN, '--file_name', input_fname, '--cutoff', '1', '--metric_type', 'L',
+                           '--method', 'pattern', '--include_duplicates', 'false', '--stream', 'true'],
+                          text=True, capture_output=True)
+  assert result.returncode != 0, 'pattern method accepted --stream true'
+  # the output file is a link to a full device: every write fails
+  for stream in ('false', 'true'):
+    output_fname = f'{input_fname}_pp_1_L'
+    if os.path.exists(output_fname):
+      os.remove(output_fname)
+    os.symlink('/dev/full', output_fname)
+    result = subprocess.run([PATTERN_JOIN, '--file_name', input_fname, '--cutoff', '1', '--metric_type', 'L',
+                             '--method', 'partition_pattern', '--include_duplicates', 'false', '--stream', stream],
+                            text=True, capture_output=True)
+    os.remove(output_fname)
+    assert result.returncode != 0, f'failed writes to a full device were not reported, stream: {stream}'
+  print('Done.')
+
+
+def read_nodes(output_fname: str) -> list[str]:
+  with open(output_fname + '.nodes') as f:
+    return f.read().split('\n')[:-1]
+
+
+def read_binary(fname: str) -> list[tuple[int]]:
+  with open(fname, 'rb') as f:
+    data = f.read()
+  assert data[:8] == b'PJEDGES\0'
+  n_nodes, n_pairs = struct.unpack('<QQ', data[8:24])
+  assert len(data) == 24 + 8 * n_pairs
+  values = struct.unpack(f'<{2 * n_pairs}I', data[24:])
+  return list(zip(values[::2], values[1::2]))
+
+
+def read_npy(fname: str) -> list[tuple[int]]:
+  with open(fname, 'rb') as f:
+    data = f.read()
+  assert data[:8] == b'\x93NUMPY\x01\x00'
+  header_len = struct.unpack('<H', data[8:10])[0]
+  header = data[10:10 + header_len].decode()
+  assert "'descr': '<u4'" in header
+  n_pairs = int(header.split('(')[1].split(',')[0])
+  body = data[10 + header_len:]
+  assert len(body) == 8 * n_pairs
+  values = struct.unpack(f'<{2 * n_pairs}I', body)
+  return list(zip(values[::2], values[1::2]))
+
+
+def read_csr(fname: str) -> list[tuple[int]]:
+  with open(fname, 'rb') as f:
+    data = f.read()
+  assert data[:8] == b'PJCSR\0\0\0'
+  n_nodes, n_entries = struct.unpack('<QQ', data[8:24])
+  offsets = struct.unpack(f'<{n_nodes + 1}Q', data[24:32 + 8 * n_nodes])
+  columns = struct.unpack(f'<{n_entries}I', data[32 + 8 * n_nodes:])
+  out = []
+  for row in range(n_nodes):
+    row_columns = list(columns[offsets[row]:offsets[row + 1]])
+    assert row_columns == sorted(set(row_columns))
+    out += [(row, column) for column in row_columns]
+  return out
+
+
+def read_mtx(fname: str) -> list[tuple[int]]:
+  # lower triangle, 1-based: returned in both orders, 0-based
+  with open(fname) as f:
+    assert f.readline() == '%%MatrixMarket matrix coordinate pattern symmetric\n'
+    n_rows, n_columns, n_entries = map(int, f.readline().split())
+    entries = [tuple(int(value) - 1 for value in line.split()) for line in f]
+  assert n_rows == n_columns and len(entries) == n_entries
+  assert all(column <= row < n_rows for row, column in entries)
+  return sorted({(row, column) for entry in entries for row, column in (entry, entry[::-1])})
+
+
+def read_delta(fname: str) -> list[tuple[int]]:
+  with open(fname, 'rb') as f:
+    data = f.read()
+  assert data[:8] == b'PJDELTA\0'
+  n_nodes, n_pairs = struct.unpack('<QQ', data[8:24])
+  pos = 24
+
+  def varint() -> int:
+    nonlocal pos
+    value, shift = 0, 0
+    while True:
+      byte = data[pos]
+      pos += 1
+      value |= (byte & 0x7f) << shift
+      shift += 7
+      if not byte & 0x80:
+        return value
+
+  out = []
+  while pos < len(data):
+    block_size, _ = struct.unpack('<II', data[pos:pos + 8])
+    pos += 8
+    block_end = pos + block_size
+    i = 0
+    while pos < block_end:
+      i += varint()
+      j = 0
+      for _ in range(varint()):
+        j += varint()
+        out.append((i, j))
+  assert len(out) == n_pairs and out == sorted(out)
+  return out
+
+
+def read_index_out(
+    output_fname: str,
+    output_format: str,
+    include_duplicates: str
+) -> set[tuple[str]]:
+  readers = {'binary': (read_binary, '.bin'), 'npy': (read_npy, '.npy'),
+             'csr': (read_csr, '.csr'), 'delta': (read_delta, '.delta')}
+  reader, extension = readers[output_format]
+  pairs = reader(output_fname + extension)
+  nodes = read_nodes(output_fname)
+  out = set()
+  for i, j in pairs:
+    if include_duplicates == 'true':
+      out.add((str(i), str(j)))
+      out.add((str(j), str(i)))
+    else:
+      out.add((nodes[i], nodes[j]))
+      out.add((nodes[j], nodes[i]))
+  return out
+
+
+def test_output_formats(output_formats: tuple):
+  print(f'Testing {", ".join(output_formats)} output')
+  input_fname, input_seqs = generate_random_input('formats', 'ACDEFG', (6, 12), 500, 5)
+  for dist_name in ('hamming', 'levenshtein'):
+    expected = expected_pairs(input_seqs, dist_name, 1)
+    expected_idx = expected_index_pairs(input_seqs, expected)
+    for method in ('pattern', 'semi_pattern', 'partition_pattern'):
+      for output_format in output_formats:
+        for include_duplicates in ('false', 'true'):
+          print(f'\tChecking method: {method}, distance: {dist_name}, format: {output_format}, duplicates: {include_duplicates}')
+          output_fname = run_pattern_join(input_fname, 1, dist_name, method, include_duplicates,
+                                          '--output_format', output_format)
+          got = read_index_out(output_fname, output_format, include_duplicates)
+          if output_format == 'csr':
+            assert_same(read_mtx(output_fname + '.mtx'), read_csr(output_fname + '.csr'),
+                        f'{input_fname} {method} {dist_name} mtx {include_duplicates}')
+          assert_same(got, expected_idx if include_duplicates == 'true' else expected,
+                      f'{input_fname} {method} {dist_name} {output_format} {include_duplicates}')
+  # with cutoff 0 the pairs are the lines of every group of duplicates
+  expected_idx = expected_index_pairs(input_seqs, {(seq, seq) for seq in input_seqs})
+  for output_format in output_formats:
+    for include_duplicates in ('false', 'true'):
+      print(f'\tChecking cutoff: 0, format: {output_format}, duplicates: {include_duplicates}')
+      run_pattern_join(input_fname, 0, 'levenshtein', 'partition_pattern', include_duplicates,
+                       '--output_format', output_format)
+      got = read_index_out(f'{input_fname}_dupl', output_format, 'true')
+      assert_same(got, expected_idx, f'{input_fname} cutoff 0 {output_format} {include_duplicates}')
+  print('Done.')
+
+
+def test_large_text_output():
+  # every string of seven letters over three: far more pairs than a text
+  # block holds, with indices of one to four digits
+  print('Testing text output of many blocks')
+  input_seqs = [''.join(seq) for seq in product('ACG', repeat=7)]
+  input_seqs += random.Random(19).sample(input_seqs, 300)
+  input_fname = './test_data/large_text'
+  with open(input_fname, 'w') as input_file:
+    input_file.write('\n'.join(input_seqs) + '\n')
+  for dist_name in ('hamming', 'levenshtein'):
+    expected = expected_pairs(input_seqs, dist_name, 2)
+    expected_idx = expected_index_pairs(input_seqs, expected)
+    for include_duplicates in ('false', 'true'):
+      print(f'\tChecking distance: {dist_name}, duplicates: {include_duplicates}')
+      output_fname = run_pattern_join(input_fname, 2, dist_name, 'partition_pattern', include_duplicates, threads=4)
+      assert_same(read_out(output_fname), expected_idx if include_duplicates == 'true' else expected,
+                  f'{input_fname} {dist_name} {include_duplicates}')
+  print('Done.')
+
+
+def test_large_duplicate_groups():
+  # a few strings with hundreds of copies: the expansion of one pair of
+  # groups spans many blocks
+  print('Testing expansion of large groups of duplicates')
+  rnd = random.Random(20)
+  _, seed_seqs = generate_random_input('clone_seeds', 'ACDEFG', (6, 8), 40, 20)
+  unique_seqs = list(dict.fromkeys(seed_seqs))
+  input_seqs = [seq for seq in unique_seqs for _ in range(rnd.randint(1, 150))]
+  rnd.shuffle(input_seqs)
+  input_fname = './test_data/clones'
+  with open(input_fname, 'w') as input_file:
+    input_file.write('\n'.join(input_seqs) + '\n')
+  expected_idx = expected_index_pairs(input_seqs, expected_pairs(input_seqs, 'levenshtein', 1))
+  for method in ('pattern', 'semi_pattern', 'partition_pattern'):
+    print(f'\tChecking method: {method}')
+    output_fname = run_pattern_join(input_fname, 1, 'levenshtein', method, 'true', threads=4)
+    assert_same(read_out(output_fname), expected_idx, f'{input_fname} {method} text')
+    output_fname = run_pattern_join(input_fname, 1, 'levenshtein', method, 'true', '--output_format', 'binary', threads=4)
+    assert_same(read_index_out(output_fname, 'binary', 'true'), expected_idx, f'{input_fname} {method} binary')
+  print('Done.')
+
+
+def check_duplicate_groups(output_fname: str, input_seqs: list[str], message: str):
+  unique_seqs = list(dict.fromkeys(input_seqs))
+  assert_same(read_nodes(output_fname), unique_seqs, message)
+  with open(output_fname + '.group_sizes') as f:
+    assert_same([int(size) for size in f.read().split()], [input_seqs.count(seq) for seq in unique_seqs], message)
+  with open(output_fname + '.membership') as f:
+    assert_same([unique_seqs[int(idx)] for idx in f.read().split()], input_seqs, message)
+
+
+def test_duplicate_groups():
+  print('Testing --include_duplicates groups')
+  input_fname, input_seqs = generate_random_input('groups', 'ACDEFG', (6, 12), 500, 21)
+  for dist_name in ('hamming', 'levenshtein'):
+    expected = expected_pairs(input_seqs, dist_name, 1)
+    for method in ('pattern', 'semi_pattern', 'partition_pattern'):
+      for output_format in ('text', 'binary'):
+        print(f'\tChecking method: {method}, distance: {dist_name}, format: {output_format}')
+        message = f'{input_fname} {method} {dist_name} {output_format}'
+        output_fname = run_pattern_join(input_fname, 1, dist_name, method, 'groups', '--output_format', output_format)
+        got = read_out(output_fname) if output_format == 'text' else read_index_out(output_fname, output_format, 'false')
+        assert_same(got, expected, message)
+        check_duplicate_groups(output_fname, input_seqs, message)
+  print('\tChecking cutoff: 0')
+  run_pattern_join(input_fname, 0, 'levenshtein', 'partition_pattern', 'groups')
+  check_duplicate_groups(f'{input_fname}_dupl', input_seqs, f'{input_fname} cutoff 0')
+  print('Done.')
+
+
+def expected_components(keys: list[str], pairs: set[tuple[str]]) -> tuple:
+  # labels are numbered in the order of the first key of every component
+  parent = {key: key for key in keys}
+
+  def find(key: str) -> str:
+    while parent[key] != key:
+      key = parent[key]
+    return key
+
+  for key1, key2 in pairs:
+    parent[find(key1)] = find(key2)
+  root2label = {}
+  labels, sizes = {}, []
+  for key in keys:
+    root = find(key)
+    if root not in root2label:
+      root2label[root] = len(sizes)
+      sizes.append(0)
+    labels[key] = root2label[root]
+    sizes[root2label[root]] += 1
+  return labels, sizes
+
+
+def read_key_values(fname: str) -> dict:
+  out = {}
+  with open(fname) as f:
+    for line in f:
+      key, value = line.split()
+      assert key not in out
+      out[key] = int(value)
+  return out
+
+
+def check_components(output_fname: str, labels: dict, sizes: list[int], message: str):
+  assert_same(read_key_values(output_fname + '.components'), labels, message)
+  with open(output_fname + '.component_sizes') as f:
+    assert_same([int(size) for size in f.read().split()], sizes, message)
+
+
+def test_summaries():
+  print('Testing count, degrees and components output')
+  input_fname, input_seqs = generate_random_input('summaries', 'ACDEFG', (6, 12), 500, 6)
+  for dist_name in ('hamming', 'levenshtein'):
+    expected = expected_pairs(input_seqs, dist_name, 1)
+    for include_duplicates in ('false', 'true'):
+      if include_duplicates == 'true':
+        pairs = expected_index_pairs(input_seqs, expected)
+        keys = [str(idx) for idx in range(len(input_seqs))]
+      else:
+        pairs = expected
+        keys = list(dict.fromkeys(input_seqs))
+      count = sum(1 for key1, key2 in pairs if key1 != key2) // 2
+      degrees = {key: 0 for key in keys}
+      for key1, key2 in pairs:
+        if key1 != key2:
+          degrees[key1] += 1
+      labels, sizes = expected_components(keys, pairs)
+      for method in ('pattern', 'semi_pattern', 'partition_pattern'):
+        print(f'\tChecking method: {method}, distance: {dist_name}, duplicates: {include_duplicates}')
+        message = f'{input_fname} {method} {dist_name} {include_duplicates}'
+        output_fname = run_pattern_join(input_fname, 1, dist_name, method, include_duplicates, '--output', 'count')
+        with open(output_fname + '.count') as f:
+          assert_same(int(f.read()), count, message)
+        output_fname = run_pattern_join(input_fname, 1, dist_name, method, include_duplicates, '--output', 'degrees')
+        assert_same(read_key_values(output_fname + '.degrees'), degrees, message)
+        output_fname = run_pattern_join(input_fname, 1, dist_name, method, include_duplicates, '--output', 'components')
+        check_components(output_fname, labels, sizes, message)
+  print('Done.')
+
+
+def test_oversized_components():
+  # pairs of split buckets already connected by earlier pairs are skipped
+  print('Testing components of buckets larger than SPLIT_SIM_SEARCH_THRESHOLD')
+  input_fname, input_seqs = generate_oversized_input()
+  keys = list(dict.fromkeys(input_seqs))
+  labels, sizes = expected_components(keys, expected_pairs(input_seqs, 'levenshtein', 1))
+  for n_threads in (1, 4):
+    print(f'\tChecking threads: {n_threads}')
+    output_fname = run_pattern_join(input_fname, 1, 'levenshtein', 'partition_pattern', 'false',
+                                    '--output', 'components', threads=n_threads)
+    check_components(output_fname, labels, sizes, f'{input_fname} {n_threads}')
+  print('Done.')
+
+
+def read_sharded_out(
+    output_fname: str,
+    output_format: str,
+    include_duplicates: str = 'false'
+) -> set[tuple[str]]:
+  with open(output_fname + '.manifest') as f:
+    manifest = f.read().split('\n')
+  assert manifest[0] == f'format {output_format}'
+  n_pairs = int(manifest[2].split()[1])
+  n_shards = int(manifest[3].split()[1])
+  if output_format == 'text':
+    nodes = None
+  elif include_duplicates == 'true':
+    nodes = [str(idx) for idx in range(int(manifest[1].split()[1]))]
+  else:
+    nodes = read_nodes(output_fname)
+  out = set()
+  total = 0
+  for line in manifest[4:4 + n_shards]:
+    shard_name, shard_pairs = line.split()
+    shard_fname = os.path.join(os.path.dirname(output_fname), shard_name)
+    if output_format == 'text':
+      with open(shard_fname) as f:
+        shard = [tuple(line.split()) for line in f]
+    else:
+      shard = [(nodes[i], nodes[j]) for i, j in read_binary(shard_fname)]
+    assert len(shard) == int(shard_pairs)
+    for seq1, seq2 in shard:
+      out.add((seq1, seq2))
+      out.add((seq2, seq1))
+    total += int(shard_pairs)
+  assert total == n_pairs
+  return out
+
+
+def test_sharded():
+  print('Testing --sharded true')
+  input_fname, input_seqs = generate_random_input('sharded', 'ACDEFG', (6, 12), 500, 7)
+  for dist_name in ('hamming', 'levenshtein'):
+    expected = expected_pairs(input_seqs, dist_name, 1)
+    for method in ('pattern', 'semi_pattern', 'partition_pattern'):
+      for output_format in ('text', 'binary'):
+        print(f'\tChecking method: {method}, distance: {dist_name}, format: {output_format}')
+        output_fname = run_pattern_join(input_fname, 1, dist_name, method, 'false',
+                                        '--sharded', 'true', '--output_format', output_format)
+        assert_same(read_sharded_out(output_fname, output_format), expected,
+                    f'{input_fname} {method} {dist_name} {output_format}')
+  # with cutoff 0 the shards hold the lines of every group of duplicates
+  expected_idx = expected_index_pairs(input_seqs, {(seq, seq) for seq in input_seqs})
+  for output_format in ('text', 'binary'):
+    print(f'\tChecking cutoff: 0, format: {output_format}')
+    run_pattern_join(input_fname, 0, 'levenshtein', 'partition_pattern', 'false',
+                     '--sharded', 'true', '--output_format', output_format)
+    assert_same(read_sharded_out(f'{input_fname}_dupl', output_format, 'true'), expected_idx,
+                f'{input_fname} cutoff 0 {output_format}')
+  print('Done.')
+
+
+def test_delta_reader():
+  # DeltaEdgeReader of delta_edges.hpp, compiled on its own
+  print('Testing the C++ reader of the delta format')
+  reader = './test_data/delta_reader'
+  result = subprocess.run(['c++', '-std=c++20', '-O2', '-Wall', '-Wextra', '-Werror', 'delta_reader.cpp', '-o', reader],
+                          text=True, capture_output=True)
+  assert result.returncode == 0, result.stderr
+  result = subprocess.run([reader, '--round_trip', './test_data/round_trip.delta'], text=True, capture_output=True)
+  assert result.returncode == 0, result.stderr
+  input_fname, input_seqs = generate_random_input('delta', 'ACDEFG', (6, 12), 500, 22)
+  for include_duplicates in ('false', 'true'):
+    print(f'\tChecking duplicates: {include_duplicates}')
+    output_fname = run_pattern_join(input_fname, 2, 'levenshtein', 'partition_pattern', include_duplicates,
+                                    '--output_format', 'delta')
+    result = subprocess.run([reader, output_fname + '.delta'], text=True, capture_output=True)
+    assert result.returncode == 0, result.stderr
+    got = [tuple(map(int, line.split())) for line in result.stdout.splitlines()]
+    assert_same(got, read_delta(output_fname + '.delta'), f'{output_fname}.delta {include_duplicates}')
+  print('Done.')
+
+
+def test_line_input():
+  print('Testing the parser of line inputs')
+  input_fname, input_seqs = generate_random_input('no_newline', 'ACDEFG', (6, 12), 500, 23)
+  with open(input_fname, 'w') as input_file:
+    input_file.write('\n'.join(input_seqs))
+  expected = expected_pairs(input_seqs, 'levenshtein', 1)
+  expected_idx = expected_index_pairs(input_seqs, expected)
+  for include_duplicates in ('false', 'true'):
+    print(f'\tChecking no trailing newline, duplicates: {include_duplicates}')
+    output_fname = run_pattern_join(input_fname, 1, 'levenshtein', 'partition_pattern', include_duplicates, threads=4)
+    assert_same(read_out(output_fname), expected_idx if include_duplicates == 'true' else expected,
+                f'{input_fname} {include_duplicates}')
+  empty_fname = './test_data/empty_line'
+  with open(empty_fname, 'w') as input_file:
+    input_file.write('\n'.join(input_seqs[:200] + [''] + input_seqs[200:]) + '\n')
+  for fname, error in ((empty_fname, 'Empty line'), ('./test_data/missing', 'does not exist')):
+    print(f'\tChecking error: {error}')
+    result = subprocess.run([PATTERN_JOIN, '--file_name', fname, '--cutoff', '1', '--metric_type', 'L',
+                             '--method', 'partition_pattern', '--include_duplicates', 'false'],
+                            text=True, capture_output=True)
+    assert result.returncode != 0 and error in result.stderr, f'{fname}: {result.stderr}'
+  print('Done.')
+
+
+def test_deduplication():
+  # many copies of few strings: unique ids follow the first line of every string
+  print('Testing deduplication of the input')
+  input_fname, input_seqs = generate_random_input('dedup', 'ACG', (3, 5), 3000, 24)
+  unique_seqs = list(dict.fromkeys(input_seqs))
+  expected_idx = expected_index_pairs(input_seqs, {(seq, seq) for seq in input_seqs})
+  for n_threads in (1, 4):
+    print(f'\tChecking threads: {n_threads}')
+    output_fname = run_pattern_join(input_fname, 1, 'levenshtein', 'partition_pattern', 'false',
+                                    '--output_format', 'binary', threads=n_threads)
+    assert_same(read_nodes(output_fname), unique_seqs, f'{input_fname} {n_threads} nodes')
+    run_pattern_join(input_fname, 0, 'levenshtein', 'partition_pattern', 'false', threads=n_threads)
+    assert_same(read_out(f'{input_fname}_dupl'), expected_idx, f'{input_fname} {n_threads} cutoff 0')
+  print('Done.')
+
+
+def test_input_formats():
+  print('Testing tsv, fasta and gzip input')
+  _, input_seqs = generate_random_input('records', 'ACDEFG', (6, 12), 500, 8)
+  tsv_fname = './test_data/records.tsv'
+  with open(tsv_fname, 'w') as tsv_file:
+    tsv_file.write('sequence_id\tv_call\tcdr3_aa\tproductive\r\n')
+    for idx, seq in enumerate(input_seqs):
+      tsv_file.write(f'id{idx}\tIGHV1\t{seq}\tT\r\n')
+  fasta_fname = './test_data/records.fa'
+  with open(fasta_fname, 'w') as fasta_file:
+    for idx, seq in enumerate(input_seqs):
+      fasta_file.write(f'>id{idx} some description\n')
+      for begin in range(0, len(seq), 5):
+        fasta_file.write(seq[begin:begin + 5] + '\n')
+  inputs = [(tsv_fname, 'tsv'), (fasta_fname, 'fasta')]
+  for fname, input_format in list(inputs):
+    with open(fname, 'rb') as f, gzip.open(fname + '.gz', 'wb') as gz_file:
+      gz_file.write(f.read())
+    inputs.append((fname + '.gz', input_format))
+  lines_fname = './test_data/records.gz'
+  with gzip.open(lines_fname, 'wt') as gz_file:
+    gz_file.write('\n'.join(input_seqs) + '\n')
+  inputs.append((lines_fname, 'lines'))
+  expected = expected_pairs(input_seqs, 'levenshtein', 1)
+  expected_idx = expected_index_pairs(input_seqs, expected)
+  for input_fname, input_format in inputs:
+    args = ['--input_format', input_format] + (['--column', 'cdr3_aa'] if input_format == 'tsv' else [])
+    for include_duplicates in ('false', 'true'):
+      print(f'\tChecking input: {input_fname}, duplicates: {include_duplicates}')
+      output_fname = run_pattern_join(input_fname, 1, 'levenshtein', 'partition_pattern', include_duplicates, *args)
+      assert_same(read_out(output_fname), expected_idx if include_duplicates == 'true' else expected,
+                  f'{input_fname} {include_duplicates}')
+  # empty records are rejected
+  empty_tsv = './test_data/empty_record.tsv'
+  with open(empty_tsv, 'w') as tsv_file:
+    tsv_file.write('sequence_id\tcdr3_aa\nid0\tCASS\nid1\t\n')
+  empty_fasta = './test_data/empty_record.fa'
+  with open(empty_fasta, 'w') as fasta_file:
+    fasta_file.write('>id0\nCASS\n>id1\n>id2\nCASR\n')
+  for fname, input_format in ((empty_tsv, 'tsv'), (empty_fasta, 'fasta')):
+    print(f'\tChecking empty record: {fname}')
+    result = subprocess.run([PATTERN_JOIN, '--file_name', fname, '--cutoff', '1', '--metric_type', 'L',
+                             '--method', 'partition_pattern', '--include_duplicates', 'false',
+                             '--input_format', input_format, '--column', 'cdr3_aa'],
+                            text=True, capture_output=True)
+    assert result.returncode != 0 and 'Empty' in result.stderr, f'{fname}: {result.stderr}'
+  print('Done.')
+
+
 def main():
   alphabet_and_length_list = [('abc', 8), ('ab', 10)]
   edit_distances = ('hamming', 'levenshtein')
@@ -161,6 +927,30 @@ def main():
         output_fname = f'{input_fname}_{distance}_{cutoff}'
         check_project(input_fname, output_fname, distance, cutoff)
         print('Done.')
+  test_partition_threads()
+  test_skewed_lengths()
+  test_partition_exactly_once()
+  test_short_strings()
+  test_partition_cutoffs()
+  test_length_windows()
+  test_oversized_buckets()
+  test_giant_semi_buckets()
+  test_semi_exactly_once()
+  test_pattern_threads()
+  test_semi_pattern_threads()
+  test_sorted_output()
+  test_stream()
+  test_output_formats(('binary', 'npy', 'csr', 'delta'))
+  test_large_text_output()
+  test_large_duplicate_groups()
+  test_duplicate_groups()
+  test_summaries()
+  test_oversized_components()
+  test_sharded()
+  test_delta_reader()
+  test_line_input()
+  test_deduplication()
+  test_input_formats()
   print('All tests passed.')
 
 if __name__ == '__main__':